@@ -0,0 +1,177 @@
+#include "attacks.h"
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#else
+#  include <cpuid.h>
+#endif
+
+namespace Attacks {
+	// Found offline with a sparse random search, one per square (A1 to H8). The shift is always 64 - popcount(mask).
+	constexpr std::array<FAST_64UI, Cnst::MAX64_SQUARES> rook_magic_numbers{
+		0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+		0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+		0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+		0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+		0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+		0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+		0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+		0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+		0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+		0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+		0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+		0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+		0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+		0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+		0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+		0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL,
+	};
+
+	constexpr std::array<FAST_64UI, Cnst::MAX64_SQUARES> bishop_magic_numbers{
+		0xA010041108003100ULL, 0x006082020A002900ULL, 0x6810010619200000ULL, 0x08281A0520000408ULL,
+		0x0001104001000400ULL, 0x0018901008048400ULL, 0x00040A0210245280ULL, 0x000200210808A402ULL,
+		0x9140048410821200ULL, 0x0800091010820041ULL, 0x20504804832202C0ULL, 0x0100091401081000ULL,
+		0x8021011140000012ULL, 0x0810020804450400ULL, 0x208B0542109008A2ULL, 0x0080084A08040204ULL,
+		0x0040E2A80811244CULL, 0x2505022008008108ULL, 0x0430220100420040ULL, 0x010A040420220040ULL,
+		0x1105000290400000ULL, 0x0093001200822120ULL, 0x4000A62048043004ULL, 0x280120048A015004ULL,
+		0x006090002A020814ULL, 0x44042000240800D0ULL, 0x01102800040A4400ULL, 0x1004080080220040ULL,
+		0x0001001011004024ULL, 0x0010044000805040ULL, 0x0914041200820100ULL, 0x0004821012821480ULL,
+		0x0024040500C05021ULL, 0x0088611002080200ULL, 0x0116080A00040020ULL, 0x4000020080080080ULL,
+		0x2450450140840040ULL, 0x0000880201484100ULL, 0x0222020404020092ULL, 0x8081110600002E00ULL,
+		0x2842101105000801ULL, 0x1100809008001025ULL, 0x00020202221C0400ULL, 0x0422014022009020ULL,
+		0x0210046102100C00ULL, 0xC004008082029102ULL, 0x00AA461801101200ULL, 0x0404080080201108ULL,
+		0x020542108C205002ULL, 0x0410544804100100ULL, 0x0040910841100000ULL, 0x0400200042021100ULL,
+		0x00004204850400C0ULL, 0x0200100410A42102ULL, 0x1040020801210102ULL, 0x0805040410420000ULL,
+		0x2884804130100200ULL, 0x800C262201242000ULL, 0x1058000194108800ULL, 0x0014221054420204ULL,
+		0x0104000012A02200ULL, 0x0200881003300100ULL, 0x0140400202840100ULL, 0x0402020801010201ULL,
+	};
+
+	// Returns the bitboard of square (file + x, rank + y), or 0 if it falls out of the board
+	[[nodiscard]] static constexpr FAST_64UI offset_bit(int square64, int x, int y) noexcept {
+		int file{ (square64 & 7) + x };
+		int rank{ (square64 >> 3) + y };
+		if (file < Enums::A_FILE || file > Enums::H_FILE || rank < Enums::RANK1 || rank > Enums::RANK8) return 0ULL;
+		return 1ULL << (rank * 8 + file);
+	}
+
+	void initialize_leapers() noexcept {
+		constexpr std::array<std::array<int, 2>, 8> knight_offsets{ { {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2} } };
+		constexpr std::array<std::array<int, 2>, 8> king_offsets{ { {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1} } };
+
+		for (int square{}; square < Cnst::MAX64_SQUARES; ++square) {
+			for (const auto& [x, y] : knight_offsets) knight_attacks[square] |= offset_bit(square, x, y);
+			for (const auto& [x, y] : king_offsets)   king_attacks[square] |= offset_bit(square, x, y);
+
+			pawn_attacks[Enums::WHITE][square] = offset_bit(square, -1, 1) | offset_bit(square, 1, 1);
+			pawn_attacks[Enums::BLACK][square] = offset_bit(square, -1, -1) | offset_bit(square, 1, -1);
+		}
+	}
+
+	// Slow attack generation, walks each ray until it meets an occupied square or the edge of the board.
+	// Used only to fill the magic tables. With edges_excluded the last square of every ray is dropped (relevant occupancy mask)
+	[[nodiscard]] static FAST_64UI ray_attacks(int square64, FAST_64UI occupancy, const std::array<std::array<int, 2>, 4>& directions, bool edges_excluded) noexcept {
+		FAST_64UI attacks{};
+		for (const auto& [x, y] : directions) {
+			for (int distance{ 1 }; FAST_64UI current{ offset_bit(square64, x * distance, y * distance) }; ++distance) {
+				if (edges_excluded && !offset_bit(square64, x * (distance + 1), y * (distance + 1))) break;
+				attacks |= current;
+				if (occupancy & current) break;
+			}
+		}
+		return attacks;
+	}
+
+	static void initialize_magics(std::array<Magic, Cnst::MAX64_SQUARES>& magics, FAST_64UI* table, const std::array<FAST_64UI, Cnst::MAX64_SQUARES>& magic_numbers,
+		const std::array<std::array<int, 2>, 4>& directions) noexcept {
+		FAST_64UI* current_slice{ table };
+
+		for (int square{}; square < Cnst::MAX64_SQUARES; ++square) {
+			Magic& current{ magics[square] };
+			current.mask = ray_attacks(square, 0ULL, directions, true);
+			current.magic = magic_numbers[square];
+			current.shift = 64 - static_cast<int>(__popcnt64(current.mask));
+			current.attacks = current_slice;
+
+			// Carry-Rippler trick: enumerates every subset of the mask
+			FAST_64UI subset{};
+			do {
+				current.attacks[current.index(subset)] = ray_attacks(square, subset, directions, false);
+				subset = (subset - current.mask) & current.mask;
+			} while (subset);
+
+			current_slice += 1ULL << (64 - current.shift);
+		}
+	}
+
+	void initialize_sliders() noexcept {
+		constexpr std::array<std::array<int, 2>, 4> rook_directions{ { {1, 0}, {-1, 0}, {0, 1}, {0, -1} } };
+		constexpr std::array<std::array<int, 2>, 4> bishop_directions{ { {1, 1}, {1, -1}, {-1, 1}, {-1, -1} } };
+
+		initialize_magics(rook_magics, rook_table.data(), rook_magic_numbers, rook_directions);
+		initialize_magics(bishop_magics, bishop_table.data(), bishop_magic_numbers, bishop_directions);
+	}
+
+	void initialize_lines() noexcept {
+		for (int first{}; first < Cnst::MAX64_SQUARES; ++first) {
+			for (int second{}; second < Cnst::MAX64_SQUARES; ++second) {
+				FAST_64UI ends{ (1ULL << first) | (1ULL << second) };
+				if (first == second) continue;
+
+				if (rook_attacks(first, 0ULL) & (1ULL << second)) {
+					line_bb[first][second] = (rook_attacks(first, 0ULL) & rook_attacks(second, 0ULL)) | ends;
+					between_bb[first][second] = rook_attacks(first, 1ULL << second) & rook_attacks(second, 1ULL << first);
+				}
+				else if (bishop_attacks(first, 0ULL) & (1ULL << second)) {
+					line_bb[first][second] = (bishop_attacks(first, 0ULL) & bishop_attacks(second, 0ULL)) | ends;
+					between_bb[first][second] = bishop_attacks(first, 1ULL << second) & bishop_attacks(second, 1ULL << first);
+				}
+			}
+		}
+	}
+
+#if !defined(__BMI2__) && !(defined(_MSC_VER) && !defined(__clang__))
+	__attribute__((target("bmi2"))) std::size_t pext_index(FAST_64UI occupancy, FAST_64UI mask) noexcept {
+		return static_cast<std::size_t>(_pext_u64(occupancy, mask));
+	}
+#endif
+
+	// regs = { eax, ebx, ecx, edx }
+	static void cpuid(unsigned int leaf, unsigned int subleaf, std::array<unsigned int, 4>& regs) noexcept {
+#if defined(_MSC_VER)
+		std::array<int, 4> out{};
+		__cpuidex(out.data(), static_cast<int>(leaf), static_cast<int>(subleaf));
+		for (std::size_t index{}; index < regs.size(); ++index) regs[index] = static_cast<unsigned int>(out[index]);
+#else
+		__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	}
+
+	[[nodiscard]] bool cpu_has_fast_pext() noexcept {
+		std::array<unsigned int, 4> regs{};
+		cpuid(0, 0, regs);
+		unsigned int max_leaf{ regs[0] };
+		bool amd{ (regs[1] == 0x68747541 && regs[3] == 0x69746E65 && regs[2] == 0x444D4163)     // "AuthenticAMD"
+			|| (regs[1] == 0x6F677948 && regs[3] == 0x6E65476E && regs[2] == 0x656E6975) }; // "HygonGenuine", Zen 1 based
+		if (max_leaf < 7) return false;
+
+		cpuid(7, 0, regs);
+		if (!(regs[1] & (1U << 8))) return false; // EBX bit 8 = BMI2
+
+		// Zen 1 and Zen 2 (family 0x17, Hygon 0x18) implement pext in microcode, which is slower than a magic multiplication
+		cpuid(1, 0, regs);
+		unsigned int family{ (regs[0] >> 8) & 0xF };
+		if (family == 0xF) family += (regs[0] >> 20) & 0xFF;
+		return !amd || family >= 0x19;
+	}
+
+	void select_backend() noexcept {
+		slider_backend = cpu_has_fast_pext() ? SliderBackend::PEXT : SliderBackend::MAGIC;
+	}
+
+	void initialize() noexcept {
+		select_backend(); // Must come first: the slider tables are filled with the selected indexing
+		initialize_leapers();
+		initialize_sliders();
+		initialize_lines();
+	}
+}
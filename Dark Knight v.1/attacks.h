@@ -0,0 +1,100 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include "utilities.h"
+#include "piece_info.h"
+#include <array>
+#include <immintrin.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////
+// This file contains the precomputed attack tables used by the bitboards inside Board.
+// Every table is indexed by a 64-square index (A1 = 0, H8 = 63), see Board::squares120.
+/////////////////////////////////////////////////////////////////////////////////////////////
+
+
+namespace Attacks {
+	using attack_table = std::array<FAST_64UI, Cnst::MAX64_SQUARES>;
+
+	// Non slide pieces
+	inline attack_table knight_attacks{};
+	inline attack_table king_attacks{};
+	inline std::array<attack_table, Cnst::MAX_COLORS> pawn_attacks{}; // pawn_attacks[color][square] = squares attacked by a pawn of that color
+
+	// Slide pieces backend, chosen once at startup by select_backend() through CPUID:
+	// PEXT is used when the host supports BMI2 (and it is not microcoded, as on AMD before Zen 3), magic multiplication otherwise
+	enum class SliderBackend { MAGIC, PEXT };
+	inline SliderBackend slider_backend{ SliderBackend::MAGIC };
+
+	[[nodiscard]] bool cpu_has_fast_pext() noexcept;
+	void select_backend() noexcept;
+
+	// When the whole program is built for BMI2 pext is inlined, otherwise it lives in attacks.cpp compiled for BMI2 only,
+	// so the same binary still runs on hosts without it
+#if defined(__BMI2__) || (defined(_MSC_VER) && !defined(__clang__))
+	[[nodiscard]] __forceinline std::size_t pext_index(FAST_64UI occupancy, FAST_64UI mask) noexcept {
+		return static_cast<std::size_t>(_pext_u64(occupancy, mask));
+	}
+#else
+	[[nodiscard]] std::size_t pext_index(FAST_64UI occupancy, FAST_64UI mask) noexcept;
+#endif
+
+	// Slide pieces (fancy magic bitboards): the relevant occupancy of a square is hashed by a magic multiplication
+	// into an index of a precomputed table that holds the attacks for that exact occupancy
+	struct Magic {
+		FAST_64UI mask{};    // Relevant occupancy (the edges of the board are excluded)
+		FAST_64UI magic{};
+		FAST_64UI* attacks{}; // Start of this square's slice inside rook_table/bishop_table
+		int shift{};
+
+		// Both backends share the same table layout: 2^(64 - shift) entries per square
+		[[nodiscard]] __forceinline std::size_t index(FAST_64UI occupancy) const noexcept {
+			if (slider_backend == SliderBackend::PEXT) return pext_index(occupancy, mask);
+			return static_cast<std::size_t>(((occupancy & mask) * magic) >> shift);
+		}
+	};
+
+	constexpr inline int ROOK_TABLE_SIZE{ 102400 };
+	constexpr inline int BISHOP_TABLE_SIZE{ 5248 };
+
+	inline std::array<Magic, Cnst::MAX64_SQUARES> rook_magics{};
+	inline std::array<Magic, Cnst::MAX64_SQUARES> bishop_magics{};
+	inline std::array<FAST_64UI, ROOK_TABLE_SIZE> rook_table{};
+	inline std::array<FAST_64UI, BISHOP_TABLE_SIZE> bishop_table{};
+
+	// between_bb[a][b] = squares strictly between a and b, line_bb[a][b] = the whole line through a and b (both empty if not aligned)
+	inline std::array<attack_table, Cnst::MAX64_SQUARES> between_bb{};
+	inline std::array<attack_table, Cnst::MAX64_SQUARES> line_bb{};
+
+	void initialize_leapers() noexcept;
+	void initialize_sliders() noexcept;
+	void initialize_lines() noexcept;
+
+	void initialize() noexcept;
+
+	[[nodiscard]] __forceinline FAST_64UI rook_attacks(int square64, FAST_64UI occupancy) noexcept {
+		const Magic& current{ rook_magics[square64] };
+		return current.attacks[current.index(occupancy)];
+	}
+
+	[[nodiscard]] __forceinline FAST_64UI bishop_attacks(int square64, FAST_64UI occupancy) noexcept {
+		const Magic& current{ bishop_magics[square64] };
+		return current.attacks[current.index(occupancy)];
+	}
+
+	[[nodiscard]] __forceinline FAST_64UI queen_attacks(int square64, FAST_64UI occupancy) noexcept {
+		return rook_attacks(square64, occupancy) | bishop_attacks(square64, occupancy);
+	}
+
+	// piece must be a bishop, a rook or a queen (of either color)
+	[[nodiscard]] __forceinline FAST_64UI slide_attacks(int piece, int square64, FAST_64UI occupancy) noexcept {
+		if (PieceInfo::is_piece_bishop(piece)) return bishop_attacks(square64, occupancy);
+		if (PieceInfo::is_piece_rook(piece))   return rook_attacks(square64, occupancy);
+		return queen_attacks(square64, occupancy);
+	}
+
+	[[nodiscard]] __forceinline FAST_64UI nonslide_attacks(int piece, int square64) noexcept {
+		return PieceInfo::is_piece_knight(piece) ? knight_attacks[square64] : king_attacks[square64];
+	}
+}
+
+#endif
@@ -6,14 +6,39 @@
 #include <array>
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// This file contains anything related to the pawns (inside the Board class) which are set up to be bitboards
+// This file contains anything related to the bitboards inside the Board class (pawns, pieces and occupancy)
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
 namespace Bitboard {
-	// Pawns' bitboard masks
-	inline std::array<FAST_64UI, Cnst::MAX64_SQUARES> bitboard_setmask{};
-	inline std::array<FAST_64UI, Cnst::MAX64_SQUARES> bitboard_clearmask{};
+	// Bitboard masks, built at compile time
+	[[nodiscard]] constexpr std::array<FAST_64UI, Cnst::MAX64_SQUARES> make_mask(bool set) noexcept {
+		std::array<FAST_64UI, Cnst::MAX64_SQUARES> masks{};
+		for (int index{}; index < Cnst::MAX64_SQUARES; ++index) {
+			masks[index] = set ? (1ULL << index) : ~(1ULL << index);
+		}
+		return masks;
+	}
+
+	inline constexpr std::array<FAST_64UI, Cnst::MAX64_SQUARES> bitboard_setmask{ make_mask(true) };
+	inline constexpr std::array<FAST_64UI, Cnst::MAX64_SQUARES> bitboard_clearmask{ make_mask(false) };
+
+	// File and rank masks (A1 = bit 0)
+	constexpr inline FAST_64UI FILE_A_MASK{ 0x0101010101010101ULL };
+	constexpr inline FAST_64UI FILE_H_MASK{ FILE_A_MASK << 7 };
+	constexpr inline FAST_64UI RANK_1_MASK{ 0xFFULL };
+	[[nodiscard]] static constexpr FAST_64UI rank_mask(int rank) noexcept { return RANK_1_MASK << (8 * rank); } // rank: Enums::RANK1 to RANK8
+
+	// Moves every bit one step towards direction (a 64-square delta: +-8 vertical, +-7 and +-9 diagonal), bits wrapping around the board edge are dropped
+	template<int Direction>
+	[[nodiscard]] __forceinline static constexpr FAST_64UI shift(FAST_64UI bitboard) noexcept {
+		if constexpr (Direction == 8) return bitboard << 8;
+		else if constexpr (Direction == -8) return bitboard >> 8;
+		else if constexpr (Direction == 7) return (bitboard & ~FILE_A_MASK) << 7;
+		else if constexpr (Direction == 9) return (bitboard & ~FILE_H_MASK) << 9;
+		else if constexpr (Direction == -7) return (bitboard & ~FILE_H_MASK) >> 7;
+		else return (bitboard & ~FILE_A_MASK) >> 9;
+	}
 
 
 	// Calls lsb(bitboard), finds the first LSB that's set to 1, sets it to 0 and returns its index
@@ -29,12 +54,8 @@ namespace Bitboard {
 		return static_cast<int>(__popcnt64(bitboard));
 	}
 
-	static constexpr void initialize_mask() noexcept {
-		for (int index{}; auto & current : bitboard_setmask) {
-			current |= (1ULL << index);
-			bitboard_clearmask[index] = ~current;
-			++index;
-		}
+	[[nodiscard]] __forceinline static constexpr bool more_than_one(FAST_64UI bitboard) noexcept {
+		return bitboard & (bitboard - 1);
 	}
 
 	__forceinline static constexpr void clear_bit(FAST_64UI& bitboard, int square) noexcept {
@@ -44,9 +65,5 @@ namespace Bitboard {
 	__forceinline static constexpr void set_bit(FAST_64UI& bitboard, int square) noexcept {
 		bitboard |= bitboard_setmask[square];
 	}
-
-	constexpr void initialize() noexcept {
-		initialize_mask();
-	}
 }
 #endif
\ No newline at end of file
@@ -3,72 +3,29 @@
 #include "boardKey_generator.h"
 #include "piece_info.h"
 #include "bitboard.h"
+#include "attacks.h"
 
 #include <cstdlib>
 #include <iostream>
 
 
-void Boards::Board::initialize_board64() noexcept {
-	for (auto& curr_square : squares120) {
-		curr_square = Cnst::OUT_OF_RANGE;
-	}
-
-	for (auto& curr_square64 : squares64) {
-		curr_square64 = Cnst::OUT_OF_RANGE64;
-	}
-
-	int square64{};
-	for (int rank{ Enums::RANK1 }; rank <= Enums::RANK8; ++rank) {
-		for (int file{ Enums::A_FILE }; file <= Enums::H_FILE; ++file) {
-			int square = Utils::getSquare64(file, rank);
-			squares64[square64] = square;
-			squares120[square] = square64++;
-		}
-	}
-}
-
-void Boards::Board::initialize_ranks_files() noexcept {
-	int square{};
-	while (square < Cnst::MAX_SQUARES) {
-		get_rank[square] = get_file[square] = Enums::OFFBOARD;
-		++square;
-	}
-	square = 0;
-	for (int rank{ Enums::RANK1 }; rank <= Enums::RANK8; ++rank) {
-		for (int file{ Enums::A_FILE }; file <= Enums::H_FILE; ++file) {
-			square = Utils::getSquare64(file, rank);
-			get_file[square] = file;
-			get_rank[square] = rank;
-		}
-	}
-}
-
 void Boards::Board::board_reset() noexcept {
+	m_state = m_states.data();
+
 	// Reset king's positions
-	m_king_location[Enums::WHITE] = m_king_location[Enums::BLACK] = Enums::NO_SQUARE;
+	m_state->m_king_location[Enums::WHITE] = m_state->m_king_location[Enums::BLACK] = Enums::NO_SQUARE;
 
 	// Reset miscellaneous members
-	m_ply = m_move50_rule = m_total_ply = m_castle_rights = m_total_moves = {};
-	m_major_pieces = {};
-	m_minor_pieces = {};
-	m_big_pieces = {};
-	m_turn = Enums::WHITE;
-	m_enPassant_square = Enums::NO_SQUARE;
-	m_position_key = {};
-	m_material_count = {};
-	m_pawns = {};
-	m_pieces_left = {};
-
-	// Set all initial squares to NO SQUARE, effectively "resets" each square
-	for (auto& current_piece : m_pieces) {
-		current_piece = Enums::OFFBOARD;
-	}
-
-	// Sets the actual (allowed) squares to NO_PIECE, so they can be differentiated from NO_SQUARE. No square means off the board; no piece means a valid 
-	// square that contains no pieces.
-	for (const auto& current_sq64 : squares64) {
-		m_pieces[current_sq64] = Enums::NO_PIECE;
-	}
+	m_ply = m_total_ply = m_total_moves = m_root_total_moves = {};
+	m_state->m_move50_rule = m_state->m_castle_rights = {};
+	m_state->m_turn = Enums::WHITE;
+	m_state->m_enPassant_square = Enums::NO_SQUARE;
+	m_state->m_position_key = {};
+	m_state->m_occupancy = {};
+	m_state->m_bitboards = {};
+
+	// Only the 64 real squares are stored, so there is no off board sentinel to set up
+	m_pieces = {};
 }
 
 // Todo: switch to std::string & use istringstream
@@ -117,9 +74,8 @@ void Boards::Board::parse_fen(const char* fen) {
 		}
 		for (int index{}; index < empty_sq_count; ++index) {
 			int square64 = rank * 8 + file;
-			int square120 = squares64[square64];
 			if (piece != Enums::NO_PIECE) {
-				m_pieces[square120] = piece;
+				m_pieces[square64] = static_cast<std::int8_t>(piece);
 			}
 			++file;
 		}
@@ -128,7 +84,7 @@ void Boards::Board::parse_fen(const char* fen) {
 
 	/* 2. Side to move */
 	assert(*fen == 'w' || *fen == 'b' && "FEN must be either w or b");
-	m_turn = ((*fen == 'w') ? Enums::WHITE : Enums::BLACK);
+	m_state->m_turn = ((*fen == 'w') ? Enums::WHITE : Enums::BLACK);
 	fen += 2;
 
 	/* 3. Castling permissions */
@@ -136,16 +92,16 @@ void Boards::Board::parse_fen(const char* fen) {
 		if (*fen == ' ') break;
 		switch (*fen) {
 			// If FEN contains either Q, K, q or k, this updates the castle rights by setting the int's bits  
-		case 'Q': m_castle_rights |= Enums::QUEEN_SIDE_W; break;
-		case 'K': m_castle_rights |= Enums::KING_SIDE_W;  break;
-		case 'q': m_castle_rights |= Enums::QUEEN_SIDE_B; break;
-		case 'k': m_castle_rights |= Enums::KING_SIDE_B;  break;
+		case 'Q': m_state->m_castle_rights |= Enums::QUEEN_SIDE_W; break;
+		case 'K': m_state->m_castle_rights |= Enums::KING_SIDE_W;  break;
+		case 'q': m_state->m_castle_rights |= Enums::QUEEN_SIDE_B; break;
+		case 'k': m_state->m_castle_rights |= Enums::KING_SIDE_B;  break;
 		default: break;
 		}
 		++fen;
 	}
 	++fen;
-	assert(m_castle_rights >= 0 && m_castle_rights <= 15 && "castle rights was greater than 0 or less than 15");
+	assert(m_state->m_castle_rights >= 0 && m_state->m_castle_rights <= 15 && "castle rights was greater than 0 or less than 15");
 
 	/* 4. Enpassant squares */
 	if (*fen != '-') { // - in FEN means no enpassant square
@@ -153,25 +109,25 @@ void Boards::Board::parse_fen(const char* fen) {
 		rank = fen[1] - '1';
 		assert((file >= Enums::A_FILE && file <= Enums::H_FILE) && "invalid file or rank");
 		assert((rank >= Enums::RANK1 && rank <= Enums::RANK8) && "invalid rank");
-		m_enPassant_square = Utils::getSquare64(file, rank);
+		m_state->m_enPassant_square = static_cast<std::uint8_t>(Utils::getSquare64(file, rank));
 		fen += 3;
 	}
 	else fen += 2;
 
 	//5. Halfmove clock, useful to check whether the 50 move rule was reached */
 	if (*fen == '-') {
-		m_move50_rule = 0;
+		m_state->m_move50_rule = 0;
 		fen += 2;
 	}
 	else {
 		if (*(fen + 1) != ' ') {
 			int firstchar = fen[0] - '0';
 			int secondchar = fen[1] - '0';
-			m_move50_rule = (firstchar * 10) + secondchar;
+			m_state->m_move50_rule = static_cast<std::uint16_t>((firstchar * 10) + secondchar);
 			fen += 3;
 		}
 		else {
-			m_move50_rule = fen[0] - '0';
+			m_state->m_move50_rule = static_cast<std::uint16_t>(fen[0] - '0');
 			fen += 2;
 		}
 	}
@@ -179,199 +135,423 @@ void Boards::Board::parse_fen(const char* fen) {
 	/* 6. Total moves played so far since the beginning */
 	if (*fen == '-') m_total_moves = 0;
 	else m_total_moves = std::atoi(fen);
+	m_root_total_moves = m_total_moves;
 
-	m_position_key = HashGenerator::key_generator(*this);
-	update_material();
+	m_state->m_position_key = HashGenerator::key_generator(*this);
+	rebuild_bitboards();
+	set_check_info();
 }
 
-void Boards::Board::update_material() noexcept {
-	int square{};
-	while (square < Cnst::MAX_SQUARES) {
-		int piece = m_pieces[square];
-		if (piece != Enums::OFFBOARD && piece != Enums::NO_PIECE) {
+// Sets the bitboards and the king locations from the mailbox
+void Boards::Board::rebuild_bitboards() noexcept {
+	for (int square64{}; square64 < Cnst::MAX64_SQUARES; ++square64) {
+		int piece = m_pieces[square64];
+		if (piece != Enums::NO_PIECE) {
 			int p_color = PieceInfo::get_piece_color(piece);
-			if (PieceInfo::is_piece_big(piece)) { ++m_big_pieces[p_color]; }
-			if (PieceInfo::is_piece_major(piece)) { ++m_major_pieces[p_color]; }
-			if (PieceInfo::is_piece_minor(piece)) { ++m_minor_pieces[p_color]; }
-			m_material_count[p_color] += PieceInfo::get_piece_value(piece);
-
-			m_pieces_list[piece][m_pieces_left[piece]] = square;
-			++m_pieces_left[piece];
-			switch (piece) {
-			case Enums::W_KING: m_king_location[Enums::WHITE] = square; break;
-			case Enums::B_KING: m_king_location[Enums::BLACK] = square; break;
-			case Enums::W_PAWN:
-				Bitboard::set_bit(m_pawns[Enums::WHITE], squares120[square]);
-				Bitboard::set_bit(m_pawns[Enums::NEITHER], squares120[square]);
-				break;
-			case Enums::B_PAWN:
-				Bitboard::set_bit(m_pawns[Enums::BLACK], squares120[square]);
-				Bitboard::set_bit(m_pawns[Enums::NEITHER], squares120[square]);
-				break;
-			default: break;
-			}
+			Bitboard::set_bit(m_state->m_bitboards[piece], square64);
+			Bitboard::set_bit(m_state->m_occupancy[p_color], square64);
+			Bitboard::set_bit(m_state->m_occupancy[Enums::NEITHER], square64);
+			if (PieceInfo::is_piece_king(piece)) m_state->m_king_location[p_color] = static_cast<std::uint8_t>(squares64[square64]);
 		}
-		++square;
 	}
 }
 
-void Boards::Board::piecelist_check() const noexcept {
-	for (int curr_piece{ Enums::W_PAWN }; curr_piece <= Enums::B_KING; ++curr_piece) {
-		for (int piece_type{}; piece_type < m_pieces_left[curr_piece]; ++piece_type) {
-			assert(m_pieces[m_pieces_list[curr_piece][piece_type]] == curr_piece && "piece list failed while checking the board");
+void Boards::Board::bitboard_check() const noexcept {
+	for (int piece{ Enums::W_PAWN }; piece <= Enums::B_KING; ++piece) {
+		FAST_64UI pieces_bb{ m_state->m_bitboards[piece] };
+		while (pieces_bb) {
+			assert(m_pieces[Bitboard::pop_bit(pieces_bb)] == piece && "piece bitboards were set incorrectly");
 		}
 	}
-}
-
-void Boards::Board::counters_check(arr_size2& temp_bigpiece, arr_size2& temp_majpiece, arr_size2& temp_minpiece, arr_size2& temp_material,
-	std::array<int, Cnst::TOT_PIECE_TYPE>& temp_pieceleft) const noexcept {
 
 	for (int square64{}; square64 < Cnst::MAX64_SQUARES; ++square64) {
-		int curr_square120 = squares64[square64];
-		int curr_piece = m_pieces[curr_square120];
-		++temp_pieceleft[curr_piece];
-		int curr_color = PieceInfo::get_piece_color(curr_piece);
-
-		if (curr_piece != Enums::NO_PIECE) {
-			if (PieceInfo::is_piece_big(curr_piece))   ++temp_bigpiece[curr_color];
-			if (PieceInfo::is_piece_major(curr_piece)) ++temp_majpiece[curr_color];
-			if (PieceInfo::is_piece_minor(curr_piece)) ++temp_minpiece[curr_color];
-			temp_material[curr_color] += PieceInfo::get_piece_value(curr_piece);
-		}
+		int piece __attribute__((unused)) { m_pieces[square64] };
+		FAST_64UI square_mask __attribute__((unused)) { Bitboard::bitboard_setmask[square64] };
+		assert((piece == Enums::NO_PIECE) == !(m_state->m_occupancy[Enums::NEITHER] & square_mask) && "occupancy bitboards were set incorrectly");
+		assert((piece == Enums::NO_PIECE || (m_state->m_occupancy[PieceInfo::get_piece_color(piece)] & square_mask)) && "occupancy bitboards were set incorrectly");
 	}
+	assert((m_state->m_occupancy[Enums::WHITE] | m_state->m_occupancy[Enums::BLACK]) == m_state->m_occupancy[Enums::NEITHER] && "occupancy bitboards were set incorrectly");
+}
 
-	for (int curr_piece{ Enums::W_PAWN }; curr_piece <= Enums::B_KING; ++curr_piece) {
-		assert(temp_pieceleft[curr_piece] == pieces_left[curr_piece] && "Failed pieces_left while checking board; board was set incorrectly");
-	}
+bool Boards::Board::board_check() const noexcept { // returns bool so it can be inserted into assert and later on disabled completely
+	bitboard_check();
+
+	// Sanity checks
+	assert(m_state->m_turn == Enums::WHITE || m_state->m_turn == Enums::BLACK);
+	assert(HashGenerator::key_generator(*this) == m_state->m_position_key);
+	assert(m_state->m_enPassant_square == Enums::NO_SQUARE || (get_rank[m_state->m_enPassant_square] == Enums::RANK6 && m_state->m_turn == Enums::WHITE)
+		|| get_rank[m_state->m_enPassant_square] == Enums::RANK3 && m_state->m_turn == Enums::BLACK);
+	assert(pieces_index(m_state->m_king_location[Enums::WHITE]) == Enums::W_KING);
+	assert(pieces_index(m_state->m_king_location[Enums::BLACK]) == Enums::B_KING);
+
+	return true;
 }
 
-void Boards::Board::pawns_check(std::array<FAST_64UI, Cnst::MAX_PAWN_COLORS>& temp_pawns) const noexcept {
-	int pawns_currWhite   __attribute__((unused)) { Bitboard::bit_count(temp_pawns[Enums::WHITE]) };
-	int pawns_currBlack   __attribute__((unused)) { Bitboard::bit_count(temp_pawns[Enums::BLACK]) };
-	int pawns_currNeither __attribute__((unused)) { Bitboard::bit_count(temp_pawns[Enums::NEITHER]) };
+[[nodiscard]] bool Boards::Board::is_square_attacked(int square, char side) const noexcept {
+	assert((square_exists(square) && side_exists(side) && board_check() && "sanity checks failed"));
+#ifdef ATTACK_MAPS
+	if (side != m_state->m_turn) return check_info().m_threats & Bitboard::bitboard_setmask[squares120[square]];
+#endif
+	// A pawn of "side" attacks the square if a pawn of the opposite color standing on the square would attack it
+	int square64{ squares120[square] };
+	if (Attacks::pawn_attacks[side ^ 1][square64] & m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_PAWN, side)]) return true;
+	if (Attacks::knight_attacks[square64] & m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_KNIGHT, side)]) return true;
+	if (Attacks::king_attacks[square64] & m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_KING, side)]) return true;
+
+	FAST_64UI occupancy{ m_state->m_occupancy[Enums::NEITHER] };
+	FAST_64UI queens{ m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_QUEEN, side)] };
+	if (Attacks::rook_attacks(square64, occupancy) & (m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_ROOK, side)] | queens)) return true;
+	if (Attacks::bishop_attacks(square64, occupancy) & (m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_BISHOP, side)] | queens)) return true;
+	return false;
+}
 
-	assert((pawns_currWhite == pieces_left[Enums::W_PAWN]
-		|| pawns_currBlack == pieces_left[Enums::W_PAWN]
-		|| pawns_currNeither == pieces_left[Enums::W_PAWN] + pieces_left[Enums::B_PAWN])
-		&& "current pawns were not set up correctly");
+// Returns every piece (of both colors) attacking square64, given the occupancy
+[[nodiscard]] FAST_64UI Boards::Board::attackers_to(int square64, FAST_64UI occupancy) const noexcept {
+	return (Attacks::pawn_attacks[Enums::BLACK][square64] & m_state->m_bitboards[Enums::W_PAWN])
+		| (Attacks::pawn_attacks[Enums::WHITE][square64] & m_state->m_bitboards[Enums::B_PAWN])
+		| (Attacks::knight_attacks[square64] & (m_state->m_bitboards[Enums::W_KNIGHT] | m_state->m_bitboards[Enums::B_KNIGHT]))
+		| (Attacks::king_attacks[square64] & (m_state->m_bitboards[Enums::W_KING] | m_state->m_bitboards[Enums::B_KING]))
+		| (Attacks::rook_attacks(square64, occupancy) & (m_state->m_bitboards[Enums::W_ROOK] | m_state->m_bitboards[Enums::B_ROOK] | m_state->m_bitboards[Enums::W_QUEEN] | m_state->m_bitboards[Enums::B_QUEEN]))
+		| (Attacks::bishop_attacks(square64, occupancy) & (m_state->m_bitboards[Enums::W_BISHOP] | m_state->m_bitboards[Enums::B_BISHOP] | m_state->m_bitboards[Enums::W_QUEEN] | m_state->m_bitboards[Enums::B_QUEEN]));
 }
 
-void Boards::Board::bitboard_check(std::array<FAST_64UI, Cnst::MAX_PAWN_COLORS>& temp_pawns) const noexcept {
-	int curr_square64{};
+// Every square attacked by a piece of "side" in the current position
+[[nodiscard]] FAST_64UI Boards::Board::attacks_by(int side) const noexcept {
+	FAST_64UI occupancy{ m_state->m_occupancy[Enums::NEITHER] };
+	FAST_64UI pawns{ pawns_index(side) };
+	FAST_64UI attacked{ side == Enums::WHITE ? Bitboard::shift<7>(pawns) | Bitboard::shift<9>(pawns) : Bitboard::shift<-9>(pawns) | Bitboard::shift<-7>(pawns) };
 
-	while (temp_pawns[Enums::WHITE]) {
-		curr_square64 = Bitboard::pop_bit(temp_pawns[Enums::WHITE]);
-		assert(m_pieces[squares64[curr_square64]] == Enums::W_PAWN && "bitboard squares (white) were set incorrectly");
-	}
+	FAST_64UI knights{ m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_KNIGHT, side)] };
+	while (knights) attacked |= Attacks::knight_attacks[Bitboard::pop_bit(knights)];
 
-	while (temp_pawns[Enums::BLACK]) {
-		curr_square64 = Bitboard::pop_bit(temp_pawns[Enums::BLACK]);
-		assert(m_pieces[squares64[curr_square64]] == Enums::B_PAWN && "bitboard squares (black) were set incorrectly");
-	}
+	FAST_64UI queens{ m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_QUEEN, side)] };
+	FAST_64UI diagonals{ m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_BISHOP, side)] | queens };
+	while (diagonals) attacked |= Attacks::bishop_attacks(Bitboard::pop_bit(diagonals), occupancy);
+	FAST_64UI straights{ m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_ROOK, side)] | queens };
+	while (straights) attacked |= Attacks::rook_attacks(Bitboard::pop_bit(straights), occupancy);
+
+	return attacked | Attacks::king_attacks[squares120[m_state->m_king_location[side]]];
+}
 
-	while (temp_pawns[Enums::NEITHER]) {
-		curr_square64 = Bitboard::pop_bit(temp_pawns[Enums::NEITHER]);
-		assert(m_pieces[squares64[curr_square64]] == Enums::W_PAWN || m_pieces[squares64[curr_square64]] == Enums::B_PAWN
-			&& "bitboard squares (neither) were set incorrectly");
+// Pieces (of both colors) that are the only blocker between the king of "side" and an enemy slider, which is added to pinners.
+// The ones of "side" are pinned, the enemy ones can give a discovered check.
+[[nodiscard]] FAST_64UI Boards::Board::slider_blockers(int side, FAST_64UI& pinners) const noexcept {
+	int king64{ squares120[m_state->m_king_location[side]] };
+	int enemy{ side ^ 1 };
+	FAST_64UI queens{ m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_QUEEN, enemy)] };
+	FAST_64UI snipers{ (Attacks::rook_attacks(king64, 0ULL) & (m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_ROOK, enemy)] | queens))
+		| (Attacks::bishop_attacks(king64, 0ULL) & (m_state->m_bitboards[PieceInfo::get_colored_piece(Enums::W_BISHOP, enemy)] | queens)) };
+
+	FAST_64UI blockers{};
+	while (snipers) {
+		int sniper64{ Bitboard::pop_bit(snipers) };
+		FAST_64UI between{ Attacks::between_bb[king64][sniper64] & m_state->m_occupancy[Enums::NEITHER] };
+		if (between && !Bitboard::more_than_one(between)) {
+			blockers |= between;
+			pinners |= Bitboard::bitboard_setmask[sniper64];
+		}
 	}
+	return blockers;
 }
 
-bool Boards::Board::board_check() const noexcept { // returns bool so it can be inserted into assert and later on disabled completely
-	std::cout << "test" << std::endl;
-	std::array<int, Cnst::TOT_PIECE_TYPE> temp_pieceleft{};
-	std::array<FAST_64UI, Cnst::MAX_PAWN_COLORS> temp_pawns{ m_pawns[Enums::WHITE], m_pawns[Enums::BLACK], m_pawns[Enums::NEITHER] };
-	arr_size2 temp_bigpiece{};
-	arr_size2 temp_majpiece{};
-	arr_size2 temp_minpiece{};
-	arr_size2 temp_material{};
-
-	piecelist_check();
-	counters_check(temp_bigpiece, temp_majpiece, temp_minpiece, temp_material, temp_pieceleft);
-	pawns_check(temp_pawns);
-	bitboard_check(temp_pawns);
+// Fills the check info of the current ply, called once the position is set up (after parse_fen and after every move)
+void Boards::Board::set_check_info() noexcept {
+	if (m_total_ply == static_cast<int>(m_check_info.size())) m_check_info.resize(m_check_info.size() * 2);
+	CheckInfo& info{ m_check_info[m_total_ply] };
+	int side{ m_state->m_turn };
+	FAST_64UI occupancy{ m_state->m_occupancy[Enums::NEITHER] };
+
+	info.m_checkers = attackers_to(squares120[m_state->m_king_location[side]], occupancy) & m_state->m_occupancy[side ^ 1];
+	info.m_pinners = {};
+	info.m_blockers[Enums::WHITE] = slider_blockers(Enums::WHITE, info.m_pinners[Enums::WHITE]);
+	info.m_blockers[Enums::BLACK] = slider_blockers(Enums::BLACK, info.m_pinners[Enums::BLACK]);
+
+	int enemy_king64{ squares120[m_state->m_king_location[side ^ 1]] };
+	info.m_check_squares[Enums::W_PAWN - 1] = Attacks::pawn_attacks[side ^ 1][enemy_king64];
+	info.m_check_squares[Enums::W_KNIGHT - 1] = Attacks::knight_attacks[enemy_king64];
+	info.m_check_squares[Enums::W_BISHOP - 1] = Attacks::bishop_attacks(enemy_king64, occupancy);
+	info.m_check_squares[Enums::W_ROOK - 1] = Attacks::rook_attacks(enemy_king64, occupancy);
+	info.m_check_squares[Enums::W_QUEEN - 1] = info.m_check_squares[Enums::W_BISHOP - 1] | info.m_check_squares[Enums::W_ROOK - 1];
+
+#ifdef ATTACK_MAPS
+	info.m_threats = attacks_by(side ^ 1);
+#endif
+}
 
-	// Sanity checks
-	assert(temp_material[Enums::WHITE] == m_material_count[Enums::WHITE] && temp_material[Enums::BLACK] == m_material_count[Enums::BLACK]);
-	assert(temp_minpiece[Enums::WHITE] == m_minor_pieces[Enums::WHITE] && temp_minpiece[Enums::BLACK] == m_minor_pieces[Enums::BLACK]);
-	assert(temp_majpiece[Enums::WHITE] == m_major_pieces[Enums::WHITE] && temp_majpiece[Enums::BLACK] == m_major_pieces[Enums::BLACK]);
-	assert(temp_bigpiece[Enums::WHITE] == m_big_pieces[Enums::WHITE] && temp_bigpiece[Enums::BLACK] == m_big_pieces[Enums::BLACK]);
-	assert(m_turn == Enums::WHITE || m_turn == Enums::BLACK);
-	assert(HashGenerator::key_generator(*this) == position_key);
-	assert(m_enPassant_square == Enums::NO_SQUARE || (get_rank[m_enPassant_square] == Enums::RANK6 && m_turn == Enums::WHITE)
-		|| get_rank[m_enPassant_square] == Enums::RANK3 && m_turn == Enums::BLACK);
-	assert(m_pieces[m_king_location[Enums::WHITE]] == Enums::W_KING);
-	assert(m_pieces[m_king_location[Enums::BLACK]] == Enums::B_KING);
+// Whether a pseudo legal move leaves the own king safe. The pins and checkers come from the check info of the position,
+// so that most moves are accepted without any attack test
+[[nodiscard]] bool Boards::Board::is_legal(int move) const noexcept {
+	FAST_64UI checkers{ check_info().m_checkers };
+	FAST_64UI pinned{ pinned_pieces(m_state->m_turn) };
+	int from64{ squares120[MoveUtils::get_from(move)] };
+	int to64{ squares120[MoveUtils::get_to(move)] };
+	int king64{ squares120[m_state->m_king_location[m_state->m_turn]] };
+	FAST_64UI enemies{ m_state->m_occupancy[m_state->m_turn ^ 1] };
 
-	return true;
+	if (MoveUtils::is_enpassant(move)) {
+		// Two pieces leave the rank at once: just look at the resulting occupancy
+		FAST_64UI captured{ Bitboard::bitboard_setmask[m_state->m_turn == Enums::WHITE ? to64 - 8 : to64 + 8] };
+		FAST_64UI occupancy{ (m_state->m_occupancy[Enums::NEITHER] ^ Bitboard::bitboard_setmask[from64] ^ captured) | Bitboard::bitboard_setmask[to64] };
+		return !(attackers_to(king64, occupancy) & enemies & ~captured);
+	}
+
+	if (from64 == king64) {
+#ifdef ATTACK_MAPS
+		// Out of check no slider aims at the king, so it cannot step along a line it is hiding
+		if (!checkers) return !(check_info().m_threats & Bitboard::bitboard_setmask[to64]);
+#endif
+		// The king is removed from the occupancy, so that it cannot hide behind itself from a slider
+		return !(attackers_to(to64, m_state->m_occupancy[Enums::NEITHER] ^ Bitboard::bitboard_setmask[king64]) & enemies);
+	}
+
+	if (checkers) {
+		if (Bitboard::more_than_one(checkers)) return false; // Double check: only the king can move
+		if (!((Attacks::between_bb[king64][Utils::lsb(checkers)] | checkers) & Bitboard::bitboard_setmask[to64])) return false;
+	}
+
+	return !(pinned & Bitboard::bitboard_setmask[from64]) || (Attacks::line_bb[from64][king64] & Bitboard::bitboard_setmask[to64]);
 }
 
-[[nodiscard]] bool Boards::Board::is_square_attacked(int square, char side) const noexcept {
-	assert((square_exists(square) && side_exists(side) && board_check() && "sanity checks failed"));
+// Whether a move (typically coming from the transposition table) could have been generated in this position, without generating anything.
+// It only has to be pseudo legal: is_legal still decides whether the own king is left in check
+[[nodiscard]] bool Boards::Board::is_pseudo_legal(int move) const noexcept {
+	if (move == Enums::INCORRECT_MOVE) return false;
+	int from{ MoveUtils::get_from(move) };
+	int to{ MoveUtils::get_to(move) };
+	if (!square_exists(from) || !square_exists(to)) return false;
 
-	if (side == Enums::WHITE && (m_pieces[square + PieceInfo::upright] == Enums::W_PAWN
-		|| m_pieces[square + PieceInfo::upleft] == Enums::W_PAWN)) return true;
-	else if (side == Enums::BLACK && (m_pieces[square + PieceInfo::downright] == Enums::B_PAWN
-		|| m_pieces[square + PieceInfo::downleft] == Enums::B_PAWN)) return true;
+	int piece{ pieces_index(from) };
+	if (piece == Enums::NO_PIECE || PieceInfo::get_piece_color(piece) != m_state->m_turn) return false;
 
-	int piece{};
-	for (auto& curr_king : PieceInfo::kingqueen_attacks) {
-		piece = m_pieces[square + curr_king];
-		if (piece != Enums::OFFBOARD && PieceInfo::is_piece_king(piece) && PieceInfo::get_piece_color(piece) == side) {
-			return true;
+	int from64{ squares120[from] };
+	int to64{ squares120[to] };
+	int captured{ MoveUtils::get_capt(move) };
+	int promoted{ MoveUtils::get_prom(move) };
+	FAST_64UI to_mask{ Bitboard::bitboard_setmask[to64] };
+
+	if (MoveUtils::is_enpassant(move)) {
+		return PieceInfo::is_piece_pawn(piece) && to == m_state->m_enPassant_square && captured == Enums::NO_PIECE && promoted == Enums::NO_PIECE
+			&& (Attacks::pawn_attacks[m_state->m_turn][from64] & to_mask);
+	}
+
+	// The captured piece is part of the move, so it has to be the one standing on the target square
+	if (pieces_index(to) != captured || (captured != Enums::NO_PIECE && PieceInfo::get_piece_color(captured) == m_state->m_turn)) return false;
+
+	if (MoveUtils::is_castle(move)) {
+		if (!PieceInfo::is_piece_king(piece) || promoted != Enums::NO_PIECE || captured != Enums::NO_PIECE) return false;
+		switch (to) {
+			case Enums::G1: return m_state->m_turn == Enums::WHITE && from == Enums::E1 && (m_state->m_castle_rights & Enums::KING_SIDE_W) && pieces_index(Enums::F1) == Enums::NO_PIECE
+				&& !is_square_attacked(Enums::E1, Enums::BLACK) && !is_square_attacked(Enums::F1, Enums::BLACK);
+			case Enums::C1: return m_state->m_turn == Enums::WHITE && from == Enums::E1 && (m_state->m_castle_rights & Enums::QUEEN_SIDE_W) && pieces_index(Enums::D1) == Enums::NO_PIECE
+				&& pieces_index(Enums::B1) == Enums::NO_PIECE && !is_square_attacked(Enums::E1, Enums::BLACK) && !is_square_attacked(Enums::D1, Enums::BLACK);
+			case Enums::G8: return m_state->m_turn == Enums::BLACK && from == Enums::E8 && (m_state->m_castle_rights & Enums::KING_SIDE_B) && pieces_index(Enums::F8) == Enums::NO_PIECE
+				&& !is_square_attacked(Enums::E8, Enums::WHITE) && !is_square_attacked(Enums::F8, Enums::WHITE);
+			case Enums::C8: return m_state->m_turn == Enums::BLACK && from == Enums::E8 && (m_state->m_castle_rights & Enums::QUEEN_SIDE_B) && pieces_index(Enums::D8) == Enums::NO_PIECE
+				&& pieces_index(Enums::B8) == Enums::NO_PIECE && !is_square_attacked(Enums::E8, Enums::WHITE) && !is_square_attacked(Enums::D8, Enums::WHITE);
+			default: return false;
 		}
 	}
 
-	for (auto& current : PieceInfo::knight_attacks) {
-		piece = m_pieces[square + current];
-		if (piece != Enums::OFFBOARD && PieceInfo::is_piece_knight(piece) && PieceInfo::get_piece_color(piece) == side) {
-			return true;
+	if (PieceInfo::is_piece_pawn(piece)) {
+		// A pawn reaching the last rank must promote (to a knight, bishop, rook or queen of its own color), and only then
+		int last_rank{ m_state->m_turn == Enums::WHITE ? Enums::RANK8 : Enums::RANK1 };
+		if ((get_rank[to] == last_rank) != (promoted != Enums::NO_PIECE)) return false;
+		if (promoted != Enums::NO_PIECE && (promoted < PieceInfo::get_colored_piece(Enums::W_KNIGHT, m_state->m_turn) || promoted > PieceInfo::get_colored_piece(Enums::W_QUEEN, m_state->m_turn))) return false;
+
+		int forward{ m_state->m_turn == Enums::WHITE ? 10 : -10 };
+		if (captured != Enums::NO_PIECE) return !MoveUtils::is_pawnfirst(move) && (Attacks::pawn_attacks[m_state->m_turn][from64] & to_mask);
+		if (MoveUtils::is_pawnfirst(move)) {
+			return get_rank[from] == (m_state->m_turn == Enums::WHITE ? Enums::RANK2 : Enums::RANK7) && to == from + forward * 2 && pieces_index(from + forward) == Enums::NO_PIECE;
 		}
+		return to == from + forward;
 	}
 
-	for (auto& curr_rook : PieceInfo::rook_attacks) {
-		int temp_square{ square + curr_rook };
-		piece = m_pieces[temp_square];
-		while (piece != Enums::OFFBOARD) {
-			if (piece != Enums::NO_PIECE) {
-				if (PieceInfo::rook_or_queen(piece) && PieceInfo::get_piece_color(piece) == side) {
-					return true;
-				} break; // The existing piece is neither a rook or a queen, so the current square in X direction is not attacked 
-			}
-			temp_square += curr_rook;
-			piece = m_pieces[temp_square];
+	if (promoted != Enums::NO_PIECE || MoveUtils::is_pawnfirst(move)) return false;
+	if (PieceInfo::is_piece_knight(piece) || PieceInfo::is_piece_king(piece)) return Attacks::nonslide_attacks(piece, from64) & to_mask;
+	return Attacks::slide_attacks(piece, from64, m_state->m_occupancy[Enums::NEITHER]) & to_mask;
+}
+
+// Static exchange evaluation: whether the sequence of captures on the target square of move, each side always recapturing with its
+// least valuable piece (and being free to stop), wins at least threshold for the side to move. Sliders hidden behind a capturer (x-rays)
+// join the exchange as soon as the square in front of them is emptied. Pins are ignored.
+[[nodiscard]] bool Boards::Board::see_ge(int move, int threshold) const noexcept {
+	// Castling, en passant and promotions are never losing
+	if (MoveUtils::is_castle(move) || MoveUtils::is_enpassant(move) || MoveUtils::is_promotion(move)) return threshold <= 0;
+
+	int from64{ squares120[MoveUtils::get_from(move)] };
+	int to64{ squares120[MoveUtils::get_to(move)] };
+
+	int swap{ PieceInfo::get_piece_value(pieces_index(MoveUtils::get_to(move))) - threshold };
+	if (swap < 0) return false; // Not enough even if the opponent does not recapture
+
+	swap = PieceInfo::get_piece_value(pieces_index(MoveUtils::get_from(move))) - swap;
+	if (swap <= 0) return true; // Enough even if the capturer is lost
+
+#ifdef ATTACK_MAPS
+	// Nothing can recapture: the target square is not attacked, and neither is the starting one, through which a slider could see it
+	if (!(check_info().m_threats & (Bitboard::bitboard_setmask[from64] | Bitboard::bitboard_setmask[to64]))) return true;
+#endif
+
+	FAST_64UI occupancy{ m_state->m_occupancy[Enums::NEITHER] ^ Bitboard::bitboard_setmask[from64] ^ Bitboard::bitboard_setmask[to64] };
+	FAST_64UI attackers{ attackers_to(to64, occupancy) };
+	FAST_64UI diagonals{ m_state->m_bitboards[Enums::W_BISHOP] | m_state->m_bitboards[Enums::B_BISHOP] | m_state->m_bitboards[Enums::W_QUEEN] | m_state->m_bitboards[Enums::B_QUEEN] };
+	FAST_64UI straights{ m_state->m_bitboards[Enums::W_ROOK] | m_state->m_bitboards[Enums::B_ROOK] | m_state->m_bitboards[Enums::W_QUEEN] | m_state->m_bitboards[Enums::B_QUEEN] };
+	int side{ m_state->m_turn };
+	bool result{ true };
+
+	while (true) {
+		side ^= 1;
+		attackers &= occupancy;
+		FAST_64UI side_attackers{ attackers & m_state->m_occupancy[side] };
+		if (!side_attackers) break;
+		result = !result;
+
+		// Least valuable attacker
+		int type{ Enums::W_PAWN };
+		FAST_64UI current{};
+		for (; type <= Enums::W_KING; ++type) {
+			current = side_attackers & m_state->m_bitboards[PieceInfo::get_colored_piece(type, side)];
+			if (current) break;
 		}
+
+		// The king can only recapture when the other side has no attackers left
+		if (type == Enums::W_KING) return (attackers & m_state->m_occupancy[side ^ 1]) ? !result : result;
+
+		swap = PieceInfo::get_piece_value(type) - swap;
+		if (swap < static_cast<int>(result)) break;
+
+		occupancy ^= Bitboard::bitboard_setmask[Utils::lsb(current)];
+		if (type == Enums::W_PAWN || type == Enums::W_BISHOP || type == Enums::W_QUEEN) attackers |= Attacks::bishop_attacks(to64, occupancy) & diagonals;
+		if (type == Enums::W_ROOK || type == Enums::W_QUEEN) attackers |= Attacks::rook_attacks(to64, occupancy) & straights;
 	}
+	return result;
+}
 
-	for (auto& curr_bishop : PieceInfo::bishop_attacks) { // curr_bishop = direction 
-		int temp_square{ square + curr_bishop };
-		piece = m_pieces[temp_square];
-		while (piece != Enums::OFFBOARD) {
-			if (piece != Enums::NO_PIECE) {
-				if (PieceInfo::bishop_or_queen(piece) && PieceInfo::get_piece_color(piece) == side) {
-					return true;
-				} break;
-			}
-			temp_square += curr_bishop;
-			piece = m_pieces[temp_square];
+// Rebuilds a full move from a compact one (see MoveUtils::compress), reading the captured piece and the pawn first move flag from the board.
+// Nothing is checked: a move coming from the transposition table or the killers still has to go through is_pseudo_legal
+[[nodiscard]] int Boards::Board::expand_move(COMPACT_MOVE move) const noexcept {
+	if (move == 0) return Enums::INCORRECT_MOVE;
+	int from64{ MoveUtils::get_compact_from(move) };
+	int to64{ MoveUtils::get_compact_to(move) };
+	int from{ squares64[from64] };
+	int to{ squares64[to64] };
+
+	switch (move & MoveUtils::compact_special) {
+		case MoveUtils::compact_enpassant: return MoveUtils::gen_singlemove(from, to, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::enpassant);
+		case MoveUtils::compact_castle:	   return MoveUtils::gen_singlemove(from, to, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::castle);
+		case MoveUtils::compact_promotion:
+			return MoveUtils::gen_singlemove(from, to, m_pieces[to64], PieceInfo::get_colored_piece(MoveUtils::get_compact_prom(move), m_state->m_turn));
+		default: {
+			bool pawnfirst{ PieceInfo::is_piece_pawn(m_pieces[from64]) && (to64 - from64 == 16 || from64 - to64 == 16) };
+			return MoveUtils::gen_singlemove(from, to, m_pieces[to64], Enums::NO_PIECE, pawnfirst ? MoveUtils::pawnfirst : 0);
 		}
 	}
-	return false;
 }
 
+// Transposition table related (best moves in the current position)
+// score is relative to the root (mate scores included), flags is its bound (see TT::Flags), eval the static evaluation or TT::NO_EVAL
+void Boards::Board::store_transposition(int move, int score, int eval, int depth, int flags) noexcept {
+	m_transp_table.store(m_state->m_position_key, MoveUtils::compress(move), TT::score_to_tt(score, m_ply), eval, depth, flags);
+}
+
+// move and eval are set to the stored ones whenever the position is found. Returns true if the stored score was searched at least as deep
+// as depth and its bound allows a cutoff with the current window: score is then the value to return (fail hard, as in Search::alpha_beta)
+[[nodiscard]] bool Boards::Board::probe_transposition(int& move, int& score, int& eval, int alpha, int beta, int depth) const noexcept {
+	const TT::InfoTT* entry{ m_transp_table.probe(m_state->m_position_key) };
+	if (!entry) return false;
+
+	move = expand_move(entry->best_move);
+	eval = entry->eval;
+	if (entry->depth < depth) return false;
+
+	score = TT::score_from_tt(entry->score, m_ply);
+	switch (entry->flags()) {
+		case TT::ALPHA:
+			if (score <= alpha) {
+				score = alpha;
+				return true;
+			}
+			return false;
+		case TT::BETA:
+			if (score >= beta) {
+				score = beta;
+				return true;
+			}
+			return false;
+		case TT::EXACT: return true;
+		default: return false;
+	}
+}
+
+[[nodiscard]] int Boards::Board::get_transposition_move() const noexcept {
+	const TT::InfoTT* entry{ m_transp_table.probe(m_state->m_position_key) };
+	return entry ? expand_move(entry->best_move) : static_cast<int>(Enums::INCORRECT_MOVE);
+}
+
+// The move must be pseudo legal: it is only played if it does not leave the own king in check
 bool Boards::Board::make_move(int move) noexcept {
+	if (!is_legal(move)) return false;
+	make_legal_move(move);
+	return true;
+}
+
+[[nodiscard]] FAST_64UI Boards::Board::key_after(int move) const noexcept {
 	int from{ MoveUtils::get_from(move) };
 	int to{ MoveUtils::get_to(move) };
-	int side{ m_turn };
-	assert(Board::square_exists(from) && Board::square_exists(from) && board_check()
-		&& Board::side_exists(m_turn) && Board::piece_exists(m_pieces[from]));
+	int piece{ pieces_index(from) };
+	int promoted{ MoveUtils::get_prom(move) };
+	int captured{ MoveUtils::get_capt(move) };
 
-	// Update position key before move is applied
-	m_history[m_total_ply].m_position_key = m_position_key;
+	FAST_64UI key{ m_state->m_position_key ^ HashGenerator::side_key() ^ HashGenerator::piece_key(piece, from) };
+	key ^= HashGenerator::piece_key(promoted != Enums::NO_PIECE ? promoted : piece, to);
+	if (captured != Enums::NO_PIECE) key ^= HashGenerator::piece_key(captured, to);
+
+	if (MoveUtils::is_enpassant(move)) {
+		key ^= m_state->m_turn == Enums::WHITE ? HashGenerator::piece_key(Enums::B_PAWN, to - 10) : HashGenerator::piece_key(Enums::W_PAWN, to + 10);
+	}
+	else if (MoveUtils::is_castle(move)) {
+		int rook{ m_state->m_turn == Enums::WHITE ? Enums::W_ROOK : Enums::B_ROOK };
+		if (to == Enums::C1)	  key ^= HashGenerator::piece_key(rook, Enums::A1) ^ HashGenerator::piece_key(rook, Enums::D1);
+		else if (to == Enums::C8) key ^= HashGenerator::piece_key(rook, Enums::A8) ^ HashGenerator::piece_key(rook, Enums::D8);
+		else if (to == Enums::G1) key ^= HashGenerator::piece_key(rook, Enums::H1) ^ HashGenerator::piece_key(rook, Enums::F1);
+		else if (to == Enums::G8) key ^= HashGenerator::piece_key(rook, Enums::H8) ^ HashGenerator::piece_key(rook, Enums::F8);
+	}
+
+	if (m_state->m_enPassant_square != Enums::NO_SQUARE) key ^= HashGenerator::enpassant_key(m_state->m_enPassant_square);
+	if (MoveUtils::is_pawnfirst(move)) key ^= HashGenerator::enpassant_key(m_state->m_turn == Enums::WHITE ? from + 10 : from - 10);
+
+	int castle_rights{ m_state->m_castle_rights & MoveUtils::get_castle_perm(from) & MoveUtils::get_castle_perm(to) };
+	return key ^ HashGenerator::castle_key(m_state->m_castle_rights) ^ HashGenerator::castle_key(castle_rights);
+}
+
+void Boards::Board::make_legal_move(int move) noexcept {
+	int from{ MoveUtils::get_from(move) };
+	int to{ MoveUtils::get_to(move) };
+	assert(Board::square_exists(from) && Board::square_exists(from) && board_check()
+		&& Board::side_exists(m_state->m_turn) && Board::piece_exists(pieces_index(from)));
+
+	// The child's cluster is fetched while the move is being made, the probe at the next node then finds it in cache
+	FAST_64UI child_key{ key_after(move) };
+	m_transp_table.prefetch(child_key);
+
+#ifdef COPY_MAKE
+	// The previous state stays one slot below, only the move is needed to put the mailbox back
+	push_state();
+	m_state->m_move = move;
+#else
+	// Undo record, taken before the move is applied
+	PreviousBoardState& previous{ push_history() };
+	previous.m_position_key = m_state->m_position_key;
+	previous.m_move = move;
+	previous.m_move50_rule = m_state->m_move50_rule;
+	previous.m_castle_rights = m_state->m_castle_rights;
+	previous.m_enPassant_square = m_state->m_enPassant_square;
+#endif
 
 	int white_enpassant{ to - 10 };
 	int black_enpassant{ to + 10 };
 	if (MoveUtils::is_enpassant(move)) { // move is enpassant
-		remove_piece(m_turn == Enums::WHITE ? white_enpassant : black_enpassant);
+		remove_piece(m_state->m_turn == Enums::WHITE ? white_enpassant : black_enpassant);
 	}
 
 	else if (MoveUtils::is_castle(move)) { // move is castle
@@ -381,36 +561,30 @@ bool Boards::Board::make_move(int move) noexcept {
 		else if (to == Enums::G8) move_piece(Enums::H8, Enums::F8);
 	}
 
-	if (m_enPassant_square != Enums::NO_SQUARE) hash_epsquare();
+	if (m_state->m_enPassant_square != Enums::NO_SQUARE) hash_epsquare();
 	hash_castle();
 
-	// Update history
-	m_history[m_total_ply].m_move = move;
-	m_history[m_total_ply].m_move50_rule = m_move50_rule;
-	m_history[m_total_ply].m_castle_rights = m_castle_rights;
-	m_history[m_total_ply].m_enPassant_square = m_enPassant_square;
-
 	// Update castle rights + 50 move rule
-	m_castle_rights &= MoveUtils::get_castle_perm(from);
-	m_castle_rights &= MoveUtils::get_castle_perm(to);
-	m_enPassant_square = Enums::NO_SQUARE;
+	m_state->m_castle_rights &= MoveUtils::get_castle_perm(from);
+	m_state->m_castle_rights &= MoveUtils::get_castle_perm(to);
+	m_state->m_enPassant_square = Enums::NO_SQUARE;
 	hash_castle();
-	++m_move50_rule;
+	++m_state->m_move50_rule;
 
 	// Captured piece exists
 	if (MoveUtils::get_capt(move) != Enums::NO_PIECE) {
 		remove_piece(to);
-		m_move50_rule = 0; // after a capture, the fifty move rule must be reseted
+		m_state->m_move50_rule = 0; // after a capture, the fifty move rule must be reseted
 	}
 	++m_total_ply;
 	++m_ply;
 
 	int white_ep{ from + 10 };
 	int black_ep{ from - 10 };
-	if (PieceInfo::is_piece_pawn(m_pieces[from])) {
-		m_move50_rule = 0;
+	if (PieceInfo::is_piece_pawn(pieces_index(from))) {
+		m_state->m_move50_rule = 0;
 		if (MoveUtils::is_pawnfirst(move)) {
-			m_enPassant_square = (m_turn == Enums::WHITE) ? white_ep : black_ep;
+			m_state->m_enPassant_square = static_cast<std::uint8_t>((m_state->m_turn == Enums::WHITE) ? white_ep : black_ep);
 			hash_epsquare();
 			// Assert get_rank[enPassant_square]==3 for white and ==6 for black
 		}
@@ -424,132 +598,102 @@ bool Boards::Board::make_move(int move) noexcept {
 		add_piece(to, promoted);
 	}
 
-	if (PieceInfo::is_piece_king(m_pieces[to])) {
-		m_king_location[m_turn] = to;
+	if (PieceInfo::is_piece_king(pieces_index(to))) {
+		m_state->m_king_location[m_state->m_turn] = static_cast<std::uint8_t>(to);
 	}
-	m_turn ^= 1; // Switch side
+	m_state->m_turn ^= 1; // Switch side
 	hash_side();
 
 	m_total_moves = m_total_ply;
+	set_check_info();
 
-	assert(board_check());
-	if (is_square_attacked(m_king_location[side], m_turn)) {// King of the side before the move was applied is attacked by the current side
-		unmake_move();
-		return false;
-	}
-	return true;
+	assert(board_check() && m_state->m_position_key == child_key);
 }
 
 void Boards::Board::remove_piece(int square) noexcept {
-	int piece_color{ PieceInfo::get_piece_color(m_pieces[square]) };
+	int square64{ Board::squares120[square] };
+	int piece{ m_pieces[square64] };
+	int piece_color{ PieceInfo::get_piece_color(piece) };
 	assert(piece_color == Enums::WHITE || piece_color == Enums::BLACK);
-
-	int piece{ m_pieces[square] };
 	assert(Board::square_exists(square) && Board::piece_exists(piece));
-	hash_piece(piece, square);
-	m_material_count[piece_color] -= PieceInfo::get_piece_value(piece);
-	m_pieces[square] = Enums::NO_PIECE;
 
-	if (PieceInfo::is_piece_big(piece)) {
-		--m_big_pieces[piece_color];
-		if (PieceInfo::is_piece_major(piece)) --m_major_pieces[piece_color];
-		else --m_minor_pieces[piece_color];
-	}
-	else {
-		Bitboard::clear_bit(m_pawns[piece_color], Board::squares120[square]);
-		Bitboard::clear_bit(m_pawns[Enums::NEITHER], Board::squares120[square]);
-	}
+	hash_piece(piece, square);
+	m_pieces[square64] = Enums::NO_PIECE;
 
-	int index{};
-	while (index < m_pieces_left[piece]) {
-		if (m_pieces_list[piece][index] == square) {
-			--m_pieces_left[piece];
-			m_pieces_list[piece][index] = m_pieces_list[piece][m_pieces_left[piece]];
-			// ^ last piece in pieces_lift shifted to the removed element, effectively "hides" the piece to be removed
-			break;
-		}
-		++index;
-	}
+	Bitboard::clear_bit(m_state->m_bitboards[piece], square64);
+	Bitboard::clear_bit(m_state->m_occupancy[piece_color], square64);
+	Bitboard::clear_bit(m_state->m_occupancy[Enums::NEITHER], square64);
 }
 
 void Boards::Board::add_piece(int square, int piece) noexcept {
 	int piece_color{ PieceInfo::get_piece_color(piece) };
 	assert(Board::square_exists(square) && Board::piece_exists(piece));
 
-	m_pieces[square] = piece;
+	int square64{ Board::squares120[square] };
+	m_pieces[square64] = static_cast<std::int8_t>(piece);
 	hash_piece(piece, square);
 
-	if (PieceInfo::is_piece_big(piece)) {
-		++m_big_pieces[piece_color];
-		if (PieceInfo::is_piece_major(piece)) ++m_major_pieces[piece_color];
-		else ++m_minor_pieces[piece_color];
-	}
-	else {
-		Bitboard::set_bit(m_pawns[piece_color], Board::squares120[square]);
-		Bitboard::set_bit(m_pawns[Enums::NEITHER], Board::squares120[square]);
-	}
-
-	m_material_count[piece_color] += PieceInfo::get_piece_value(piece);
-	m_pieces_list[piece][m_pieces_left[piece]] = square;
-	++m_pieces_left[piece];
+	Bitboard::set_bit(m_state->m_bitboards[piece], square64);
+	Bitboard::set_bit(m_state->m_occupancy[piece_color], square64);
+	Bitboard::set_bit(m_state->m_occupancy[Enums::NEITHER], square64);
 }
 
 void Boards::Board::move_piece(unsigned int from, unsigned int to) noexcept {
-	int piece{ m_pieces[from] };
+	int from64{ squares120[from] };
+	int to64{ squares120[to] };
+	int piece{ m_pieces[from64] };
 	int color{ PieceInfo::get_piece_color(piece) };
 
 	hash_piece(piece, from);
-	m_pieces[from] = Enums::NO_PIECE;
+	m_pieces[from64] = Enums::NO_PIECE;
 	hash_piece(piece, to);
-	m_pieces[to] = piece;
-
-	if (!PieceInfo::is_piece_big(piece)) {
-		Bitboard::clear_bit(m_pawns[color], squares120[from]);
-		Bitboard::clear_bit(m_pawns[Enums::NEITHER], squares120[from]);
-		Bitboard::set_bit(m_pawns[color], squares120[to]);
-		Bitboard::set_bit(m_pawns[Enums::NEITHER], squares120[to]);
-	}
+	m_pieces[to64] = static_cast<std::int8_t>(piece);
 
-	for (int index{}; index < m_pieces_left[piece]; ++index) {
-		if (m_pieces_list[piece][index] == from) {
-			m_pieces_list[piece][index] = to;
-			break;
-		}
-	}
+	// from and to squares are toggled in a single xor
+	FAST_64UI from_to{ Bitboard::bitboard_setmask[from64] | Bitboard::bitboard_setmask[to64] };
+	m_state->m_bitboards[piece] ^= from_to;
+	m_state->m_occupancy[color] ^= from_to;
+	m_state->m_occupancy[Enums::NEITHER] ^= from_to;
 }
 
 void Boards::Board::unmake_move() noexcept {
 	assert(board_check());
 	--m_total_ply;
 	--m_ply;
-
+#ifdef COPY_MAKE
+	// The previous state is still untouched one slot below, only the mailbox has to be put back
+	int move{ m_state->m_move };
+	m_state = &m_states[m_total_ply];
+	m_total_moves = m_total_ply ? m_total_ply : m_root_total_moves;
+	unmake_mailbox(move);
+#else
 	int move{ m_history[m_total_ply].m_move };
 	int from{ MoveUtils::get_from(move) };
 	int to{ MoveUtils::get_to(move) };
 
 	assert(Board::square_exists(from) && Board::square_exists(from)
-		&& Board::side_exists(m_turn) && Board::piece_exists(m_pieces[from]));
+		&& Board::side_exists(m_state->m_turn) && Board::piece_exists(pieces_index(from)));
 
 	if (enPassant_square() != Enums::NO_SQUARE) hash_epsquare();
 	hash_castle();
 
-	m_castle_rights = m_history[m_total_ply].m_castle_rights;
-	m_move50_rule = m_history[m_total_ply].m_move50_rule;
-	m_enPassant_square = m_history[m_total_ply].m_enPassant_square;
+	m_state->m_castle_rights = m_history[m_total_ply].m_castle_rights;
+	m_state->m_move50_rule = m_history[m_total_ply].m_move50_rule;
+	m_state->m_enPassant_square = m_history[m_total_ply].m_enPassant_square;
 
-	m_total_moves = m_history[m_total_ply].m_total_moves;
+	m_total_moves = m_total_ply ? m_total_ply : m_root_total_moves;
 
 	if (enPassant_square() != Enums::NO_SQUARE) hash_epsquare();
 	hash_castle();
 
-	m_turn ^= 1;
+	m_state->m_turn ^= 1;
 	hash_side();
 
 
 	int white_enpassant{ to - 10 };
 	int black_enpassant{ to + 10 };
 	if (MoveUtils::is_enpassant(move)) { // move was enpassant
-		if (m_turn == Enums::WHITE) add_piece(white_enpassant, Enums::B_PAWN);
+		if (m_state->m_turn == Enums::WHITE) add_piece(white_enpassant, Enums::B_PAWN);
 		else add_piece(black_enpassant, Enums::W_PAWN);
 	}
 
@@ -561,7 +705,7 @@ void Boards::Board::unmake_move() noexcept {
 	}
 
 	move_piece(to, from);
-	if (PieceInfo::is_piece_king(m_pieces[from])) m_king_location[m_turn] = from;
+	if (PieceInfo::is_piece_king(pieces_index(from))) m_state->m_king_location[m_state->m_turn] = static_cast<std::uint8_t>(from);
 
 	int captured{ MoveUtils::get_capt(move) };
 	if (captured != Enums::NO_PIECE) add_piece(to, captured);
@@ -571,34 +715,77 @@ void Boards::Board::unmake_move() noexcept {
 		remove_piece(from);
 		add_piece(from, PieceInfo::get_piece_color(promoted) == Enums::WHITE ? Enums::W_PAWN : Enums::B_PAWN);
 	}
+#endif
 	assert(board_check());
 }
 
+#ifdef COPY_MAKE
+// Puts back on the mailbox the pieces moved by "move", once m_state is the state the move was made from
+void Boards::Board::unmake_mailbox(int move) noexcept {
+	int to{ MoveUtils::get_to(move) };
+	int from64{ squares120[MoveUtils::get_from(move)] };
+	int to64{ squares120[to] };
+
+	m_pieces[from64] = MoveUtils::get_prom(move) != Enums::NO_PIECE
+		? static_cast<std::int8_t>(PieceInfo::get_colored_piece(Enums::W_PAWN, m_state->m_turn)) : m_pieces[to64];
+	m_pieces[to64] = static_cast<std::int8_t>(MoveUtils::get_capt(move));
+
+	if (MoveUtils::is_enpassant(move)) {
+		if (m_state->m_turn == Enums::WHITE) m_pieces[to64 - 8] = Enums::B_PAWN;
+		else m_pieces[to64 + 8] = Enums::W_PAWN;
+	}
+	else if (MoveUtils::is_castle(move)) {
+		auto castle_rook = [this](int rook_from, int rook_to) {
+			m_pieces[squares120[rook_from]] = m_pieces[squares120[rook_to]];
+			m_pieces[squares120[rook_to]] = Enums::NO_PIECE;
+		};
+		if (to == Enums::C1)	  castle_rook(Enums::A1, Enums::D1);
+		else if (to == Enums::C8) castle_rook(Enums::A8, Enums::D8);
+		else if (to == Enums::G1) castle_rook(Enums::H1, Enums::F1);
+		else castle_rook(Enums::H8, Enums::F8);
+	}
+}
+#endif
+
 void Boards::Board::make_nullmove() noexcept {
+	FAST_64UI child_key{ m_state->m_position_key ^ HashGenerator::side_key() };
+	if (m_state->m_enPassant_square != Enums::NO_SQUARE) child_key ^= HashGenerator::enpassant_key(m_state->m_enPassant_square);
+	m_transp_table.prefetch(child_key);
+
+#ifdef COPY_MAKE
+	push_state();
+#else
+	PreviousBoardState& previous{ push_history() };
+	previous.m_position_key = m_state->m_position_key;
+	previous.m_move = Enums::INCORRECT_MOVE;
+	previous.m_move50_rule = m_state->m_move50_rule;
+	previous.m_enPassant_square = m_state->m_enPassant_square;
+	previous.m_castle_rights = m_state->m_castle_rights;
+#endif
 	++m_ply;
-	m_history[m_total_ply].m_position_key = m_position_key;
-	if (m_enPassant_square != Enums::NO_SQUARE) hash_epsquare();
-	m_history[m_total_ply].m_move = Enums::INCORRECT_MOVE;
-	m_history[m_total_ply].m_move50_rule = m_move50_rule;
-	m_history[m_total_ply].m_enPassant_square = m_enPassant_square;
-	m_history[m_total_ply].m_castle_rights = m_castle_rights;
-	m_enPassant_square = Enums::NO_SQUARE;
-	m_turn ^= 1;
+	if (m_state->m_enPassant_square != Enums::NO_SQUARE) hash_epsquare();
+	m_state->m_enPassant_square = Enums::NO_SQUARE;
+	m_state->m_turn ^= 1;
 	++m_total_ply;
 	hash_side();
+	set_check_info();
 }
 
 void Boards::Board::unmake_nullmove() {
 	--m_total_ply;
 	--m_ply;
-	if (m_enPassant_square != Enums::NO_SQUARE) hash_epsquare();
-	m_castle_rights = m_history[m_total_ply].m_castle_rights;
-	m_enPassant_square = m_history[m_total_ply].m_enPassant_square;
-	m_move50_rule = m_history[m_total_ply].m_move50_rule;
+#ifdef COPY_MAKE
+	m_state = &m_states[m_total_ply];
+#else
+	if (m_state->m_enPassant_square != Enums::NO_SQUARE) hash_epsquare();
+	m_state->m_castle_rights = m_history[m_total_ply].m_castle_rights;
+	m_state->m_enPassant_square = m_history[m_total_ply].m_enPassant_square;
+	m_state->m_move50_rule = m_history[m_total_ply].m_move50_rule;
 	
-	if (m_enPassant_square != Enums::NO_SQUARE) hash_epsquare();
-	m_turn ^= 1;
+	if (m_state->m_enPassant_square != Enums::NO_SQUARE) hash_epsquare();
+	m_state->m_turn ^= 1;
 	hash_side();
+#endif
 
 }
 
@@ -611,7 +798,7 @@ void Boards::Board::print_board() const noexcept {
 		std::cout << 8 - rank;
 		for (int file{ Enums::A_FILE }; file <= Enums::H_FILE; ++file) {
 			int square = Utils::getSquare64(file, 7 - rank);
-			int piece = m_pieces[square];
+			int piece = pieces_index(square);
 			std::cout << "   " << Cnst::piece_str[piece];
 		}
 		std::cout << '\n';
@@ -622,14 +809,14 @@ void Boards::Board::print_board() const noexcept {
 		std::cout << "   " << static_cast<char>(file + 'a');
 	}
 	std::cout << "\n\n";
-	std::cout << "Side: " << Cnst::side_str[m_turn] << '\n';
-	std::cout << "En passant: " << m_enPassant_square << '\n';
+	std::cout << "Side: " << Cnst::side_str[m_state->m_turn] << '\n';
+	std::cout << "En passant: " << enPassant_square() << '\n';
 	std::cout << "Castle rights: " <<
-		(m_castle_rights & Enums::KING_SIDE_W ? 'K' : '-') <<
-		(m_castle_rights & Enums::QUEEN_SIDE_W ? 'Q' : '-') <<
-		(m_castle_rights & Enums::KING_SIDE_B ? 'k' : '-') <<
-		(m_castle_rights & Enums::QUEEN_SIDE_B ? 'q' : '-') << '\n';
-	std::cout << "Position key: " << m_position_key << '\n';
-	std::cout << "Move 50 rule: " << m_move50_rule << '\n';
+		(m_state->m_castle_rights & Enums::KING_SIDE_W ? 'K' : '-') <<
+		(m_state->m_castle_rights & Enums::QUEEN_SIDE_W ? 'Q' : '-') <<
+		(m_state->m_castle_rights & Enums::KING_SIDE_B ? 'k' : '-') <<
+		(m_state->m_castle_rights & Enums::QUEEN_SIDE_B ? 'q' : '-') << '\n';
+	std::cout << "Position key: " << m_state->m_position_key << '\n';
+	std::cout << "Move 50 rule: " << m_state->m_move50_rule << '\n';
 	std::cout << "Total moves: " << m_total_moves << '\n';
 }
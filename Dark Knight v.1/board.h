@@ -3,9 +3,12 @@
 
 #include "utilities.h"
 #include "transposition_table.h"
+#include "boardKey_generator.h"
 #include "nnue.h"
 
 #include <array>
+#include <cstdint>
+#include <vector>
 #include "nnue.h"
 
 
@@ -15,137 +18,177 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 namespace Boards {
-	// Contains only stuff that cannot be recovered from BoardState
+	// Square conversion tables (see Board::squares120 and Board::squares64), built at compile time
+	[[nodiscard]] constexpr std::array<int, Cnst::MAX_SQUARES> make_squares120() noexcept {
+		std::array<int, Cnst::MAX_SQUARES> squares{};
+		for (auto& square : squares) square = Cnst::OUT_OF_RANGE;
+		for (int rank{ Enums::RANK1 }; rank <= Enums::RANK8; ++rank) {
+			for (int file{ Enums::A_FILE }; file <= Enums::H_FILE; ++file) {
+				squares[Utils::getSquare64(file, rank)] = rank * 8 + file;
+			}
+		}
+		return squares;
+	}
+
+	[[nodiscard]] constexpr std::array<int, Cnst::MAX64_SQUARES> make_squares64() noexcept {
+		std::array<int, Cnst::MAX64_SQUARES> squares{};
+		for (int square64{}; square64 < Cnst::MAX64_SQUARES; ++square64) {
+			squares[square64] = Utils::getSquare64(square64 % 8, square64 / 8);
+		}
+		return squares;
+	}
+
+	// File (Rank = false) or rank (Rank = true) of every 120-square index, Enums::OFFBOARD outside of the board
+	template<bool Rank>
+	[[nodiscard]] constexpr std::array<int, Cnst::MAX_SQUARES> make_ranks_files() noexcept {
+		std::array<int, Cnst::MAX_SQUARES> values{};
+		for (auto& value : values) value = Enums::OFFBOARD;
+		for (int rank{ Enums::RANK1 }; rank <= Enums::RANK8; ++rank) {
+			for (int file{ Enums::A_FILE }; file <= Enums::H_FILE; ++file) {
+				values[Utils::getSquare64(file, rank)] = Rank ? rank : file;
+			}
+		}
+		return values;
+	}
+
+	// Contains only stuff that cannot be recovered from BoardState (16 bytes)
 	struct PreviousBoardState {
 		FAST_64UI m_position_key{};
-		int m_enPassant_square{};
-		int m_move50_rule{};
-		int m_total_moves{};
-		int m_turn{};
 		int m_move{};
-		int m_castle_rights{};
+		std::uint16_t m_move50_rule{};
+		std::uint8_t m_enPassant_square{}; // 120-square index
+		std::uint8_t m_castle_rights{};
+	};
+
+	using bitwise_array = std::array<FAST_64UI, Cnst::MAX_PAWN_COLORS>;
+
+	// Everything a move changes, apart from the ply counters and the mailbox (Board::m_pieces). With COPY_MAKE it is copied one slot
+	// up the state stack on every move, so that unmaking a move only steps back to the previous slot; otherwise there is only one,
+	// updated in place. Piece counts are not stored, they are read from the bitboards (152 bytes with COPY_MAKE, 144 without)
+	struct PositionState {
+		std::array<FAST_64UI, Cnst::TOT_PIECE_TYPE> m_bitboards{};  // One bitboard per piece type, indexed by Enums::Piece
+		bitwise_array m_occupancy{};									 // All the pieces of WHITE, BLACK and NEITHER (both colors)
+		FAST_64UI m_position_key{};
+#ifdef COPY_MAKE
+		int m_move{};												 // Move that led to this state, the mailbox is restored from it
+#endif
+		std::uint16_t m_move50_rule{};
+		std::uint8_t m_castle_rights{};
+		std::uint8_t m_enPassant_square{};							 // 120-square index
+		std::uint8_t m_turn{};
+		std::array<std::uint8_t, Cnst::MAX_KING_COLORS> m_king_location{}; // 120-square index
+	};
+
+	// Check related bitboards of a position, computed once after each move (see Board::set_check_info) and shared by
+	// the move generation, the legality test and the search
+	struct CheckInfo {
+		FAST_64UI m_checkers{};										// Enemy pieces giving check to the side to move
+		std::array<FAST_64UI, Cnst::MAX_COLORS> m_blockers{};		// Only pieces (of both colors) between the king of a side and an enemy slider
+		std::array<FAST_64UI, Cnst::MAX_COLORS> m_pinners{};		// Enemy sliders behind those blockers
+		std::array<FAST_64UI, Enums::W_KING> m_check_squares{};	// Squares from where each piece type (W_PAWN to W_QUEEN) of the side to move checks the enemy king
+#ifdef ATTACK_MAPS
+		FAST_64UI m_threats{};										// Squares attacked by the side not to move
+#endif
 	};
 
+#ifdef COPY_MAKE
+	constexpr inline int COPY_MAKE_STATES{ Cnst::HISTORY_RESERVE };
+#else
+	constexpr inline int COPY_MAKE_STATES{ 1 };
+#endif
+
 	class Board {
 	private:
 		TT::TranspositionTable m_transp_table{};
-		std::array<int, Cnst::MAX_DEPTH> m_pv_moves{};
-		std::array<PreviousBoardState, Cnst::MAX_TOTAL_MOVES> m_history{};
-		std::array<int, Cnst::MAX_SQUARES> m_pieces{};
-		std::array<int, Cnst::TOT_PIECE_TYPE> m_pieces_left{}; // Contains numbers of each piece-type left (ie 2 knights, 1 bishop, etc)
-		std::array<std::array<int, Cnst::MAX_SQUARES>, Cnst::TOT_PIECE_TYPE> m_search_heuristics{}; // Updated when alpha is beaten by move or piece
-		std::array<std::array<int, Cnst::MAX_DEPTH>, 2> m_killer_moves{}; // Moves that caused B-cutoff
-
-		// Contains square of each piece (faster for move generation)
-		std::array<std::array<int, Cnst::MAX_SINGLE_PIECE>, Cnst::TOT_PIECE_TYPE> m_pieces_list{};
-
-		std::array<int, Cnst::MAX_COLORS> m_big_pieces{};		 // Bishops, knights, rooks, queen
-		std::array<int, Cnst::MAX_COLORS> m_minor_pieces{};    // Bishops/Knights
-		std::array<int, Cnst::MAX_COLORS> m_major_pieces{};	 // Rooks/Queen
-		std::array<int, Cnst::MAX_KING_COLORS> m_king_location{};
-		std::array<int, Cnst::MAX_COLORS> m_material_count{};
-
-		// Bitwise representations
-		using bitwise_array = std::array<FAST_64UI, Cnst::MAX_PAWN_COLORS>;
-		bitwise_array m_pawns{};
+		std::array<COMPACT_MOVE, Cnst::MAX_DEPTH> m_pv_moves{};
+#ifndef COPY_MAKE
+		std::vector<PreviousBoardState> m_history = std::vector<PreviousBoardState>(Cnst::HISTORY_RESERVE); // Undo stack, indexed by m_total_ply
+#endif
+		std::array<std::array<int, Cnst::MAX64_SQUARES>, Cnst::TOT_PIECE_TYPE> m_search_heuristics{}; // Updated when alpha is beaten by move or piece (64-square index)
+		std::array<std::array<COMPACT_MOVE, Cnst::MAX_DEPTH>, 2> m_killer_moves{}; // Moves that caused B-cutoff
+
+		// Position state (see PositionState): the current one is m_states[index], copy-make moves m_state along the stack
+		std::vector<PositionState> m_states = std::vector<PositionState>(COPY_MAKE_STATES);
+		PositionState* m_state{ m_states.data() };
+		std::array<std::int8_t, Cnst::MAX64_SQUARES> m_pieces{}; // Piece on each 64-square index, kept out of the copied state
+		std::vector<CheckInfo> m_check_info = std::vector<CheckInfo>(Cnst::HISTORY_RESERVE); // Indexed by m_total_ply
 
 		// Miscellaneous
-		FAST_64UI m_position_key{};
 		int m_ply{};		 // total ply in the current search
 		int m_total_moves{}; // same as ply*2
+		int m_root_total_moves{}; // Full move number read by parse_fen, restored once every move has been unmade
 		int m_total_ply{};   // total ply since the beginning of the match (hisPly)
-		int m_move50_rule{};
-		int m_castle_rights{};
-		int m_enPassant_square{};
-		int m_turn{};
 
 	public:
-		inline static std::array<int, Cnst::MAX_SQUARES> get_rank{};
-		inline static std::array<int, Cnst::MAX_SQUARES> get_file{};
-		inline static std::array<int, Cnst::MAX_SQUARES> squares120{};
-		inline static std::array<int, Cnst::MAX64_SQUARES> squares64{};
-
-		// Hash related - these arrays will hold random generated numbers [See: Zobrist Hashing for info]
-		using piece_per_square = std::array<std::array<FAST_64UI, Cnst::MAX_SQUARES>, Cnst::TOT_PIECE_TYPE>;
-		inline static piece_per_square pieces_key{};		   // Key representing all pieces in the board
-		inline static FAST_64UI side_tomove_key{};			   // Key representing the side to move (the key represents that the side to move is black)
-		inline static std::array<FAST_64UI, 16> castle_key{};  // Key representing castle rights. 16 is preferred since castle rights is a bitset of 4 specific bits (which derive from 1, 2, 
-															   // 4 and 8, and which in total is 15)
-
-		using arr_size2 = std::array<int, Cnst::MAX_COLORS>;
+		inline static constexpr std::array<int, Cnst::MAX_SQUARES> get_rank{ make_ranks_files<true>() };
+		inline static constexpr std::array<int, Cnst::MAX_SQUARES> get_file{ make_ranks_files<false>() };
+		inline static constexpr std::array<int, Cnst::MAX_SQUARES> squares120{ make_squares120() };
+		inline static constexpr std::array<int, Cnst::MAX64_SQUARES> squares64{ make_squares64() };
 
 		Board() = default;
 		Board(Board&) = delete;
 
 		// Getters
-		[[nodiscard]] __forceinline constexpr FAST_64UI position_key() const noexcept { return m_position_key; }
+		[[nodiscard]] __forceinline constexpr FAST_64UI position_key() const noexcept { return m_state->m_position_key; }
 		[[nodiscard]] __forceinline constexpr int ply() const noexcept { return m_ply; }
 		[[nodiscard]] __forceinline constexpr int total_ply() const noexcept { return m_total_ply; }
 		[[nodiscard]] __forceinline constexpr int total_moves() const noexcept { return m_total_moves; }
-		[[nodiscard]] __forceinline constexpr int move50_rule() const noexcept { return m_move50_rule; }
-		[[nodiscard]] __forceinline constexpr int castle_rights() const noexcept { return m_castle_rights; }
-		[[nodiscard]] __forceinline constexpr int enPassant_square() const noexcept { return m_enPassant_square; }
-		[[nodiscard]] __forceinline constexpr int turn() const noexcept { return m_turn; }
-		[[nodiscard]] __forceinline constexpr const auto& pieces_list() const noexcept { return m_pieces_list; }
-		[[nodiscard]] __forceinline constexpr int pieces_list_index(std::size_t piece_type, std::size_t piece_num) const noexcept { return m_pieces_list[piece_type][piece_num]; }
-		[[nodiscard]] __forceinline constexpr const auto& big_pieces() const noexcept { return m_big_pieces; }
-		[[nodiscard]] __forceinline constexpr int big_pieces_index(std::size_t index) const noexcept { return m_big_pieces[index]; }
-		[[nodiscard]] __forceinline constexpr const auto& minor_pieces() const noexcept { return m_minor_pieces; }
-		[[nodiscard]] __forceinline constexpr int minor_pieces_index(std::size_t index) const noexcept { return m_minor_pieces[index]; }
-		[[nodiscard]] __forceinline constexpr const auto& major_pieces() const noexcept { return m_major_pieces; }
-		[[nodiscard]] __forceinline constexpr int major_pieces_index(std::size_t index) const noexcept { return m_major_pieces[index]; }
-		[[nodiscard]] __forceinline constexpr const auto& king_location() const noexcept { return m_king_location; }
-		[[nodiscard]] __forceinline constexpr int king_location_index(std::size_t index) const noexcept { return m_king_location[index]; }
-		[[nodiscard]] __forceinline constexpr const auto& material_count() const noexcept { return m_material_count; }
-		[[nodiscard]] __forceinline constexpr int material_count_index(std::size_t index) const noexcept { return m_material_count[index]; }
-		[[nodiscard]] __forceinline constexpr const auto& pawns() const noexcept { return m_pawns; }
-		[[nodiscard]] __forceinline constexpr auto pawns_index(std::size_t index) const noexcept { return m_pawns[index]; }
-		[[nodiscard]] __forceinline constexpr const auto& history() const noexcept { return m_history; }
-		[[nodiscard]] __forceinline constexpr const auto& history_index(std::size_t index) const noexcept { return m_history[index]; }
+		[[nodiscard]] __forceinline constexpr int move50_rule() const noexcept { return m_state->m_move50_rule; }
+		[[nodiscard]] __forceinline constexpr int castle_rights() const noexcept { return m_state->m_castle_rights; }
+		[[nodiscard]] __forceinline constexpr int enPassant_square() const noexcept { return m_state->m_enPassant_square; }
+		[[nodiscard]] __forceinline constexpr int turn() const noexcept { return m_state->m_turn; }
+		[[nodiscard]] __forceinline int big_pieces_index(std::size_t side) const noexcept { return Utils::popcount(m_state->m_occupancy[side] ^ pawns_index(side)); } // Every piece but pawns, the king included
+		[[nodiscard]] __forceinline constexpr int king_location_index(std::size_t side) const noexcept { return m_state->m_king_location[side]; }
+		[[nodiscard]] __forceinline constexpr FAST_64UI pawns_index(std::size_t side) const noexcept { return m_state->m_bitboards[side == Enums::WHITE ? Enums::W_PAWN : Enums::B_PAWN]; }
+		[[nodiscard]] __forceinline constexpr const auto& occupancy() const noexcept { return m_state->m_occupancy; }
+		[[nodiscard]] __forceinline constexpr auto occupancy_index(std::size_t index) const noexcept { return m_state->m_occupancy[index]; }
+		[[nodiscard]] __forceinline constexpr const auto& bitboards() const noexcept { return m_state->m_bitboards; }
+		[[nodiscard]] __forceinline constexpr auto bitboards_index(std::size_t piece) const noexcept { return m_state->m_bitboards[piece]; }
 		[[nodiscard]] __forceinline constexpr const auto& pieces() const noexcept { return m_pieces; }
-		[[nodiscard]] __forceinline constexpr int pieces_index(std::size_t index) const noexcept { return m_pieces[index]; }
-		[[nodiscard]] __forceinline constexpr const auto& pieces_left() const noexcept { return m_pieces_left; }
-		[[nodiscard]] __forceinline constexpr int pieces_left_index(std::size_t index) const noexcept { return m_pieces_left[index]; }
+		[[nodiscard]] __forceinline constexpr int pieces_index(std::size_t square120) const noexcept { return m_pieces[squares120[square120]]; } // square120 must be on the board
+		[[nodiscard]] __forceinline constexpr int piece_on(std::size_t square64) const noexcept { return m_pieces[square64]; }
+		[[nodiscard]] __forceinline int pieces_left_index(std::size_t piece) const noexcept { return Utils::popcount(m_state->m_bitboards[piece]); }
 		[[nodiscard]] __forceinline constexpr const auto& transp_table() const noexcept { return m_transp_table; }
 		[[nodiscard]] __forceinline constexpr const auto& pv_moves() const noexcept { return m_pv_moves; }
-		[[nodiscard]] __forceinline constexpr int pv_moves_index(std::size_t index) const noexcept { return m_pv_moves[index]; }
+		[[nodiscard]] __forceinline constexpr COMPACT_MOVE pv_moves_index(std::size_t index) const noexcept { return m_pv_moves[index]; }
 		[[nodiscard]] __forceinline constexpr const auto& search_heuristics() const noexcept { return m_search_heuristics; }
-		[[nodiscard]] __forceinline constexpr int search_heuristics_index(int piece_type, int square) const noexcept { return m_search_heuristics[piece_type][square]; }
-		[[nodiscard]] __forceinline constexpr int killer_moves_index(std::size_t index, int depth) const noexcept { return m_killer_moves[index][depth]; }
+		[[nodiscard]] __forceinline constexpr int search_heuristics_index(int piece_type, int square120) const noexcept { return m_search_heuristics[piece_type][squares120[square120]]; }
+		[[nodiscard]] __forceinline constexpr COMPACT_MOVE killer_moves_index(std::size_t index, int depth) const noexcept { return m_killer_moves[index][depth]; }
+		[[nodiscard]] __forceinline constexpr const auto& check_info() const noexcept { return m_check_info[m_total_ply]; }
+		[[nodiscard]] __forceinline constexpr FAST_64UI checkers() const noexcept { return check_info().m_checkers; }
+		[[nodiscard]] __forceinline constexpr bool in_check() const noexcept { return check_info().m_checkers != 0; }
+		[[nodiscard]] __forceinline constexpr FAST_64UI blockers_index(std::size_t side) const noexcept { return check_info().m_blockers[side]; }
+		[[nodiscard]] __forceinline constexpr FAST_64UI pinned_pieces(std::size_t side) const noexcept { return check_info().m_blockers[side] & m_state->m_occupancy[side]; }
+		[[nodiscard]] __forceinline constexpr FAST_64UI check_squares_index(std::size_t piece_type) const noexcept { return check_info().m_check_squares[piece_type - 1]; } // W_PAWN to W_QUEEN
 
 
 		// Miscellaneous
-		constexpr void set_pv_moves(std::size_t index, int move);
-		constexpr void incr_search_heuristics(int piece_type, int square) noexcept;
+		constexpr void set_pv_moves(std::size_t index, COMPACT_MOVE move);
+		constexpr void incr_search_heuristics(int piece_type, int square120) noexcept;
 		constexpr void reset_search_heuristics() noexcept;
 		constexpr void reset_killer_moves() noexcept;
 		void reset_transp_table() noexcept;
+		void age_transp_table() noexcept;
 		constexpr void set_ply(int ply) noexcept;
-		constexpr void transp_table_init(std::size_t index) noexcept;
-		constexpr void set_killers(std::size_t index, int ply, int new_val) noexcept;
-		constexpr void incr_search_heuristic_val(int from, int to, int new_val) noexcept;
-
-		// Initialization
-		static void initialize_board64() noexcept;
-		static void initialize_ranks_files() noexcept;
-		static void initialize() noexcept {
-			Board::initialize_board64();
-			Board::initialize_ranks_files();
-			nnue_init("nn-eba324f53044.nnue");
-		}
+		void transp_table_init(int megabytes) noexcept;
+		constexpr void set_killers(std::size_t index, int ply, COMPACT_MOVE new_val) noexcept;
+		constexpr void incr_search_heuristic_val(int piece_type, int to120, int new_val) noexcept;
 
 		// Position related
 		void board_reset() noexcept;
 		void parse_fen(const char* fen);
-		void update_material() noexcept;
+		void rebuild_bitboards() noexcept;
 		void print_board() const noexcept;
 		[[nodiscard]] bool is_square_attacked(int square, char side) const noexcept;
+		[[nodiscard]] FAST_64UI attackers_to(int square64, FAST_64UI occupancy) const noexcept;
+		[[nodiscard]] FAST_64UI attacks_by(int side) const noexcept;
+		[[nodiscard]] bool is_legal(int move) const noexcept;
+		[[nodiscard]] bool is_pseudo_legal(int move) const noexcept;
+		[[nodiscard]] int expand_move(COMPACT_MOVE move) const noexcept;
+		[[nodiscard]] bool see_ge(int move, int threshold) const noexcept;
 
 		// Board checks
-		void piecelist_check() const noexcept;
-		void counters_check(arr_size2&, arr_size2&, arr_size2&, arr_size2&, std::array<int, 13>&) const noexcept;
-		void pawns_check(std::array<FAST_64UI, Cnst::MAX_PAWN_COLORS>& temp_pawns) const noexcept;
-		void bitboard_check(std::array<FAST_64UI, Cnst::MAX_PAWN_COLORS>& temp_pawns) const noexcept;
+		void bitboard_check() const noexcept;
 		bool board_check() const noexcept;
 
 		// Sanity checks
@@ -170,43 +213,64 @@ namespace Boards {
 		}
 
 		__forceinline constexpr void hash_piece(int piece, int square) noexcept {
-			m_position_key ^= pieces_key[piece][square];
+			m_state->m_position_key ^= HashGenerator::piece_key(piece, square);
 		}
 
 		__forceinline void hash_side() noexcept {
-			m_position_key ^= side_tomove_key;
+			m_state->m_position_key ^= HashGenerator::side_key();
 		}
 
 		__forceinline constexpr void hash_castle() noexcept {
-			m_position_key ^= castle_key[m_castle_rights];
+			m_state->m_position_key ^= HashGenerator::castle_key(m_state->m_castle_rights);
 		}
 
 		__forceinline constexpr void hash_epsquare() noexcept {
-			m_position_key ^= pieces_key[Enums::NO_PIECE][m_enPassant_square];
+			m_state->m_position_key ^= HashGenerator::enpassant_key(m_state->m_enPassant_square);
 		}
 
 
 		// Move related
 		bool make_move(int move) noexcept;
+		void make_legal_move(int move) noexcept; // Fast path: the move must be legal (see MovesList::generate_legal_moves)
+		[[nodiscard]] FAST_64UI key_after(int move) const noexcept; // Position key once move is made, without making it
 		void make_nullmove() noexcept;
 		void unmake_nullmove();
 		void unmake_move() noexcept;
 		void remove_piece(int square) noexcept;
 		void add_piece(int square, int piece) noexcept;
 		void move_piece(unsigned int from, unsigned int to) noexcept;
+		void set_check_info() noexcept;
+		[[nodiscard]] FAST_64UI slider_blockers(int side, FAST_64UI& pinners) const noexcept;
+
+#ifdef COPY_MAKE
+		// Copies the current state one slot up the stack (slot index = m_total_ply) and makes it the current one
+		void push_state() {
+			if (m_total_ply + 1 == static_cast<int>(m_states.size())) m_states.resize(m_states.size() * 2);
+			m_states[m_total_ply + 1] = m_states[m_total_ply];
+			m_state = &m_states[m_total_ply + 1];
+		}
+		void unmake_mailbox(int move) noexcept;
+#else
+		// Entry for the move about to be made: the stack only grows past the game length plus the search depth reached so far
+		[[nodiscard]] PreviousBoardState& push_history() {
+			if (m_total_ply == static_cast<int>(m_history.size())) m_history.resize(m_history.size() * 2);
+			return m_history[m_total_ply];
+		}
+#endif
 		[[nodiscard]] constexpr bool is_repetition() const noexcept;
 
 		// Transposition table related (best moves in the current position)
-		void set_transposition_move(int move) noexcept;
+		void store_transposition(int move, int score, int eval, int depth, int flags) noexcept;
+		[[nodiscard]] bool probe_transposition(int& move, int& score, int& eval, int alpha, int beta, int depth) const noexcept;
 		[[nodiscard]] int get_transposition_move() const noexcept;
 	};
 
-	constexpr void Board::set_pv_moves(std::size_t index, int move) { 
+	constexpr void Board::set_pv_moves(std::size_t index, COMPACT_MOVE move) { 
 		m_pv_moves[index] = move; 
 	}
 
-	constexpr void Board::incr_search_heuristics(int piece_type, int square) noexcept { 
-		++m_search_heuristics[piece_type][square]; 
+	constexpr void Board::incr_search_heuristics(int piece_type, int square120) noexcept { 
+		++m_search_heuristics[piece_type][squares120[square120]]; 
 	}
 
 	constexpr void Board::reset_search_heuristics() noexcept { 
@@ -218,47 +282,39 @@ namespace Boards {
 		m_transp_table.reset_internal();
 	}
 
+	inline void Board::age_transp_table() noexcept {
+		m_transp_table.new_search();
+	}
+
 	constexpr void Board::set_ply(int ply) noexcept {
 		m_ply = ply; 
 	}
 
-	constexpr void Board::transp_table_init(std::size_t index) noexcept { 
-		m_transp_table.init(index); 
+	inline void Board::transp_table_init(int megabytes) noexcept { 
+		m_transp_table.init(megabytes); 
 	}
 
-	constexpr void Board::set_killers(std::size_t index, int ply, int new_val) noexcept {
+	constexpr void Board::set_killers(std::size_t index, int ply, COMPACT_MOVE new_val) noexcept {
 		m_killer_moves[index][ply] = new_val;
 	}
 
-	constexpr void Board::incr_search_heuristic_val(int from, int to, int new_val) noexcept {
-		m_search_heuristics[from][to] += new_val;
+	constexpr void Board::incr_search_heuristic_val(int piece_type, int to120, int new_val) noexcept {
+		m_search_heuristics[piece_type][squares120[to120]] += new_val;
 	}
 
 	constexpr bool Board::is_repetition() const noexcept {
 		// Consider only reversible moves (pawn moves & captures not considered, those cannot be reversed)
-		for (int current{ 4 }; current <= m_move50_rule; current += 2) {
-			if (m_position_key == m_history[m_total_ply - current].m_position_key) {
+		for (int current{ 4 }; current <= m_state->m_move50_rule && current <= m_total_ply; current += 2) {
+#ifdef COPY_MAKE
+			if (m_state->m_position_key == m_states[m_total_ply - current].m_position_key) {
+#else
+			if (m_state->m_position_key == m_history[m_total_ply - current].m_position_key) {
+#endif
 				return true;
 			}
 		}
 		return false;
 	}
 
-	// Transposition table related (best moves in the current position)
-	inline void Board::set_transposition_move(int move) noexcept {
-		int hashed_index{ static_cast<int>(m_position_key % m_transp_table.get_size()) };
-		m_transp_table.set(hashed_index, move, m_position_key, m_ply);
-	}
-
-	[[nodiscard]] inline int Board::get_transposition_move() const noexcept {
-		int hashed_index{ static_cast<int>(m_position_key % m_transp_table.get_size()) };
-
-		if (m_transp_table.get_key(hashed_index) == m_position_key) {
-			return m_transp_table.get_bestmove(hashed_index);
-		}
-
-		return static_cast<int>(Enums::INCORRECT_MOVE);
-	}
-
 }
 #endif
\ No newline at end of file
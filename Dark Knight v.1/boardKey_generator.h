@@ -1,9 +1,18 @@
 #ifndef BOARDKEY_GENERATOR_H
 #define BOARDKEY_GENERATOR_H
 #include "utilities.h"
+#include <array>
 
 /////////////////////////////////////////////////////////////////////////////////////////////
 // This file contains stuff related to the generation of a hash - see Zobrist Hashing Method
+//
+// Key layout (ZOBRIST_VERSION 1), the same on every build and platform:
+// - keys are drawn in this order from SplitMix64 with a zero seed: pieces[piece][square120] for piece
+//   NO_PIECE to B_KING and square120 0 to 119 (off board squares included), then castle[0..15], then side
+// - the key of a position XORs pieces[piece][square] for every piece, pieces[NO_PIECE][ep square] when there
+//   is an en passant square, castle[castle rights bitset] and side when WHITE is to move
+// Keys stored outside of the engine (transposition table dumps, books, indexes) should be saved along with
+// ZOBRIST_VERSION. These keys are not the Polyglot ones.
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -12,10 +21,54 @@ namespace Boards {
 }
 
 namespace HashGenerator {
-	void initialize_hash();
+	using piece_per_square = std::array<std::array<FAST_64UI, Cnst::MAX_SQUARES>, Cnst::TOT_PIECE_TYPE>;
 
-	FAST_64UI key_generator(const Boards::Board& current_board) noexcept;
+	struct ZobristKeys {
+		piece_per_square m_pieces{};			 // [piece][square120], pieces[NO_PIECE] holds the en passant squares
+		std::array<FAST_64UI, 16> m_castle{};  // Indexed by the castle rights bitset
+		FAST_64UI m_side{};
+	};
+
+	// SplitMix64: tiny and constexpr, so that the keys are computed by the compiler instead of at startup
+	[[nodiscard]] constexpr FAST_64UI splitmix64(FAST_64UI& state) noexcept {
+		FAST_64UI result{ state += 0x9E3779B97F4A7C15ULL };
+		result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		result = (result ^ (result >> 27)) * 0x94D049BB133111EBULL;
+		return result ^ (result >> 31);
+	}
+
+	[[nodiscard]] constexpr ZobristKeys make_zobrist_keys() noexcept {
+		ZobristKeys keys{};
+		FAST_64UI state{};
+		for (auto& outer : keys.m_pieces) {
+			for (auto& inner : outer) inner = splitmix64(state);
+		}
+		for (auto& current : keys.m_castle) current = splitmix64(state);
+		keys.m_side = splitmix64(state);
+		return keys;
+	}
+
+	inline constexpr ZobristKeys zobrist_keys{ make_zobrist_keys() };
 
-	void initialize();
+	// Bumped whenever a key or the way the keys are combined changes
+	constexpr inline int ZOBRIST_VERSION{ 1 };
+	static_assert(zobrist_keys.m_pieces[Enums::NO_PIECE][0] == 0xE220A8397B1DCDAFULL && zobrist_keys.m_side == 0x5932E97F6E1CC269ULL,
+		"The Zobrist keys changed: bump ZOBRIST_VERSION and update the expected values");
+
+	// Keys by board square (the 120-square index used by the board and the moves)
+	[[nodiscard]] constexpr FAST_64UI piece_key(int piece, int square) noexcept {
+		return zobrist_keys.m_pieces[piece][square];
+	}
+	[[nodiscard]] constexpr FAST_64UI enpassant_key(int square) noexcept {
+		return piece_key(Enums::NO_PIECE, square);
+	}
+	[[nodiscard]] constexpr FAST_64UI castle_key(int castle_rights) noexcept {
+		return zobrist_keys.m_castle[castle_rights];
+	}
+	[[nodiscard]] constexpr FAST_64UI side_key() noexcept { // XORed when WHITE is to move
+		return zobrist_keys.m_side;
+	}
+
+	FAST_64UI key_generator(const Boards::Board& current_board) noexcept;
 }
 #endif
\ No newline at end of file
@@ -11,26 +11,28 @@ namespace Eval {
 	// Stockfish NNUE
 	constexpr inline std::array<int, 13> nnue_pieces{ 0, 6, 5, 4, 3, 2, 1, 12, 11, 10, 9, 8, 7 };
 
-	[[nodiscard]] int evaluate_pos(const Boards::Board& board) noexcept {
+	[[nodiscard]] int network_score(const Boards::Board& board) noexcept {
 		int pieces[33];
 		int squares[33];
 
 		int index{ 2 };
 		for (int piece{ Enums::W_PAWN }; piece < Cnst::TOT_PIECE_TYPE; ++piece) {
-			for (int cpiece{ 0 }; cpiece < board.pieces_left_index(piece); ++cpiece) {
+			FAST_64UI pieces_bb{ board.bitboards_index(piece) };
+			while (pieces_bb) {
+				int square64{ Bitboard::pop_bit(pieces_bb) };
 				if (piece == Enums::W_KING) {
 					pieces[0] = nnue_pieces[piece];
-					squares[0] = Boards::Board::squares120[board.pieces_list_index(piece, cpiece)];
+					squares[0] = square64;
 				}
 
 				else if (piece == Enums::B_KING) {
 					pieces[1] = nnue_pieces[piece];
-					squares[1] = Boards::Board::squares120[board.pieces_list_index(piece, cpiece)];
+					squares[1] = square64;
 				}
 
 				else {
 					pieces[index] = nnue_pieces[piece];
-					squares[index] = Boards::Board::squares120[board.pieces_list_index(piece, cpiece)];
+					squares[index] = square64;
 					++index;
 				}
 			}
@@ -39,6 +41,14 @@ namespace Eval {
 		pieces[index] = 0;
 		squares[index] = 0;
 
-		return nnue_evaluate(board.turn(), pieces, squares) * (100 - board.move50_rule()) / 100;
+		return nnue_evaluate(board.turn(), pieces, squares);
+	}
+
+	[[nodiscard]] int scale_rule50(int score, const Boards::Board& board) noexcept {
+		return score * (100 - board.move50_rule()) / 100;
+	}
+
+	[[nodiscard]] int evaluate_pos(const Boards::Board& board) noexcept {
+		return scale_rule50(network_score(board), board);
 	}
 }
\ No newline at end of file
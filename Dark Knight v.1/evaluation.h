@@ -10,6 +10,11 @@ namespace Boards {
 }
 
 namespace Eval {
+	// Network score, not yet scaled down by the fifty move rule: the position key does not include the rule 50 counter,
+	// so this is the value the transposition table stores
+	[[nodiscard]] int network_score(const Boards::Board& board) noexcept;
+	[[nodiscard]] int scale_rule50(int score, const Boards::Board& board) noexcept;
+
 	[[nodiscard]] int evaluate_pos(const Boards::Board& board) noexcept;
 }
 
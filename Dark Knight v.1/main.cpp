@@ -6,12 +6,17 @@
 #include "uci.h"
 #include "boardKey_generator.h"
 #include "bitboard.h"
+#include "attacks.h"
+#include "nnue.h"
+
+#include <thread>
 
 int main()
 {
-	Boards::Board::initialize();
-	Bitboard::initialize();
-	HashGenerator::initialize();
+	// The square, mask and hash tables are constexpr: only the attack tables and the network are left to set up,
+	// and the network is read from disk while the attack tables are being filled
+	std::thread nnue_loader{ nnue_init, "nn-eba324f53044.nnue" };
+	Attacks::initialize();
+	nnue_loader.join();
 	UCI::uci();
 }
-
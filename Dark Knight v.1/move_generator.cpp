@@ -1,392 +1,280 @@
 #include "move_generator.h"
 #include "bitboard.h"
-
-void MovesList::gen_blackpawnmoves(const Board& position, bool quiet) noexcept {
-	constexpr int forward{ -10 };
-	constexpr int diag_right{ -11 };
-	constexpr int diag_left{ -9 };
-	constexpr int color{ Enums::B_PAWN };
-	constexpr int initial_rank{ Enums::RANK7 };
-
-	for (int currpiece{}; currpiece < position.pieces_left_index(color); ++currpiece) {
-		int square{ position.pieces_list_index(color, currpiece) };
-
-		if (position.pieces_index(square + forward) == Enums::NO_PIECE) { // pawn can march forward
-			set_blackpawn_move(position, MoveUtils::gen_singlemove(square, square + forward), quiet);
-			auto doublepawnmove = square + (forward * 2);
-			if (position.get_rank[square] == initial_rank && position.pieces_index(doublepawnmove) == Enums::NO_PIECE) { // Two-moves forward (init pawn jump)
-				set_quietmove(position, MoveUtils::gen_singlemove(square, doublepawnmove, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::pawnfirst));
-			}
-		}
-
-		// Captures diagonally
-		if (Board::square_exists(square + diag_left) &&
-			PieceInfo::get_piece_color(position.pieces_index(square + diag_left)) == Enums::WHITE) {
-			set_blackpawn_move(position, MoveUtils::gen_singlemove(square, square + diag_left, position.pieces_index(square + diag_left)));
-		}
-
-		if (Board::square_exists(square + diag_right) &&
-			PieceInfo::get_piece_color(position.pieces_index(square + diag_right)) == Enums::WHITE) {
-			set_blackpawn_move(position, MoveUtils::gen_singlemove(square, square + diag_right, position.pieces_index(square + diag_right)));
-		}
-
-		auto ep_square{ position.enPassant_square() };
-		// Enpassant captures
-		if (ep_square != Enums::NO_SQUARE) {
-			if (square + diag_left == ep_square) {
-				set_epmove(position, MoveUtils::gen_singlemove(square, square + diag_left, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::enpassant));
-			}
-
-			if (square + diag_right == ep_square) {
-				set_epmove(position, MoveUtils::gen_singlemove(square, square + diag_right, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::enpassant));
-			}
-		}
+#include "attacks.h"
+
+// One move per promoted piece
+template<int Color, bool Quiet>
+void MovesList::set_promotions(const Board& position, int from, int to, int captured) noexcept {
+	for (int promoted{ PieceInfo::get_colored_piece(Enums::W_QUEEN, Color) }; promoted >= PieceInfo::get_colored_piece(Enums::W_KNIGHT, Color); --promoted) {
+		if constexpr (Quiet) set_quietmove(position, MoveUtils::gen_singlemove(from, to, captured, promoted));
+		else set_tacticalmove(position, MoveUtils::gen_singlemove(from, to, captured, promoted));
 	}
 }
 
-void MovesList::gen_blackpawnmoves_capt(const Board& position) noexcept {
-	constexpr int diag_right{ -11 };
-	constexpr int diag_left{ -9 };
-	constexpr int color{ Enums::B_PAWN };
+template<int Color>
+void MovesList::set_piece_moves(const Board& position, int square, FAST_64UI targets) noexcept {
+	FAST_64UI captures{ targets & position.occupancy_index(Color ^ 1) };
+	while (captures) {
+		int to64{ Bitboard::pop_bit(captures) };
+		set_tacticalmove(position, MoveUtils::gen_singlemove(square, Board::squares64[to64], position.piece_on(to64)));
+	}
 
-	for (int currpiece{}; currpiece < position.pieces_left_index(color); ++currpiece) {
-		int square{ position.pieces_list_index(color, currpiece) };
+	FAST_64UI quiets{ targets & ~position.occupancy_index(Enums::NEITHER) };
+	while (quiets) {
+		set_quietmove(position, MoveUtils::gen_singlemove(square, Board::squares64[Bitboard::pop_bit(quiets)]));
+	}
+}
 
-		if (Board::square_exists(square + diag_left) &&
-			PieceInfo::get_piece_color(position.pieces_index(square + diag_left)) == Enums::WHITE) {
-			set_blackpawn_move(position, MoveUtils::gen_singlemove(square, square + diag_left, position.pieces_index(square + diag_left)));
+// targets: squares the pawns may move to (see generate). All the pawns are moved at once by shifting the pawn bitboard,
+// then each target square gives back its origin. Pushes, promotions included, are quiet moves; captures and en passant are not
+template<int Color, MovesList::GenType Type>
+void MovesList::gen_pawn_moves(const Board& position, FAST_64UI targets) noexcept {
+	constexpr int up{ Color == Enums::WHITE ? 8 : -8 };
+	constexpr int up_left{ up - 1 };
+	constexpr int up_right{ up + 1 };
+	constexpr FAST_64UI double_push_rank{ Bitboard::rank_mask(Color == Enums::WHITE ? Enums::RANK3 : Enums::RANK6) }; // After the first step
+	constexpr FAST_64UI promotion_rank{ Bitboard::rank_mask(Color == Enums::WHITE ? Enums::RANK7 : Enums::RANK2) };    // Before promoting
+
+	FAST_64UI empty{ ~position.occupancy_index(Enums::NEITHER) };
+	FAST_64UI enemies{ position.occupancy_index(Color ^ 1) };
+	FAST_64UI pawns{ position.pawns_index(Color) & ~promotion_rank };
+	FAST_64UI promoting{ position.pawns_index(Color) & promotion_rank };
+
+	if constexpr (Type != GenType::CAPTURES) {
+		FAST_64UI single{ Bitboard::shift<up>(pawns) & empty };
+		FAST_64UI doubles{ Bitboard::shift<up>(single & double_push_rank) & empty & targets };
+		single &= targets;
+
+		while (single) {
+			int to64{ Bitboard::pop_bit(single) };
+			set_quietmove(position, MoveUtils::gen_singlemove(Board::squares64[to64 - up], Board::squares64[to64]));
 		}
-
-		if (Board::square_exists(square + diag_right) &&
-			PieceInfo::get_piece_color(position.pieces_index(square + diag_right)) == Enums::WHITE) {
-			set_blackpawn_move(position, MoveUtils::gen_singlemove(square, square + diag_right, position.pieces_index(square + diag_right)));
+		while (doubles) {
+			int to64{ Bitboard::pop_bit(doubles) };
+			set_quietmove(position, MoveUtils::gen_singlemove(Board::squares64[to64 - up - up], Board::squares64[to64], Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::pawnfirst));
 		}
 
-		auto ep_square{ position.enPassant_square() };
-		if (ep_square != Enums::NO_SQUARE) {
-			if (square + diag_left == ep_square) {
-				set_epmove(position, MoveUtils::gen_singlemove(square, square + diag_left, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::enpassant));
-			}
-
-			if (square + diag_right == ep_square) {
-				set_epmove(position, MoveUtils::gen_singlemove(square, square + diag_right, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::enpassant));
-			}
+		FAST_64UI promotions{ Bitboard::shift<up>(promoting) & empty & targets };
+		while (promotions) {
+			int to64{ Bitboard::pop_bit(promotions) };
+			set_promotions<Color, true>(position, Board::squares64[to64 - up], Board::squares64[to64], Enums::NO_PIECE);
 		}
 	}
-}
 
-void MovesList::gen_whitepawnmove(const Board& position, bool quiet) noexcept {
-	constexpr int forward{ 10 };
-	constexpr int diag_right{ 11 };
-	constexpr int diag_left{ 9 };
-	constexpr int color{ Enums::W_PAWN };
-	constexpr int initial_rank{ Enums::RANK2 };
-
-	for (int currpiece{}; currpiece < position.pieces_left_index(color); ++currpiece) {
-		int square{ position.pieces_list_index(color, currpiece) };
-		if (position.pieces_index(square + forward) == Enums::NO_PIECE) { // pawn can march forward
-			set_whitepawn_move(position, MoveUtils::gen_singlemove(square, square + forward), quiet);
-			if (position.get_rank[square] == initial_rank && position.pieces_index(square + (forward + forward)) == Enums::NO_PIECE) { // Two-moves forward (init pawn jump)
-				set_quietmove(position, MoveUtils::gen_singlemove(square, square + (forward + forward), Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::pawnfirst));
-			}
+	if constexpr (Type != GenType::QUIETS) {
+		FAST_64UI victims{ enemies & targets };
+		FAST_64UI left{ Bitboard::shift<up_left>(pawns) & victims };
+		FAST_64UI right{ Bitboard::shift<up_right>(pawns) & victims };
+		while (left) {
+			int to64{ Bitboard::pop_bit(left) };
+			set_tacticalmove(position, MoveUtils::gen_singlemove(Board::squares64[to64 - up_left], Board::squares64[to64], position.piece_on(to64)));
 		}
-
-		// Captures diagonally
-		if (Board::square_exists(square + diag_left) &&
-			PieceInfo::get_piece_color(position.pieces_index(square + diag_left)) == Enums::BLACK) {
-			set_whitepawn_move(position, MoveUtils::gen_singlemove(square, square + diag_left, position.pieces_index(square + diag_left)));
-		}
-
-		if (Board::square_exists(square + diag_right) &&
-			PieceInfo::get_piece_color(position.pieces_index(square + diag_right)) == Enums::BLACK) {
-			set_whitepawn_move(position, MoveUtils::gen_singlemove(square, square + diag_right, position.pieces_index(square + diag_right)));
+		while (right) {
+			int to64{ Bitboard::pop_bit(right) };
+			set_tacticalmove(position, MoveUtils::gen_singlemove(Board::squares64[to64 - up_right], Board::squares64[to64], position.piece_on(to64)));
 		}
 
-		// Enpassant captures
-		auto ep{ position.enPassant_square() };
-		if (ep != Enums::NO_SQUARE) {
-			if (square + diag_left == ep) {
-				set_epmove(position, MoveUtils::gen_singlemove(square, square + diag_left, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::enpassant));
-			}
-			if (square + diag_right != 99 && square + diag_right == ep) {
-				set_epmove(position, MoveUtils::gen_singlemove(square, square + diag_right, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::enpassant));
-			}
+		FAST_64UI promotions_left{ Bitboard::shift<up_left>(promoting) & victims };
+		FAST_64UI promotions_right{ Bitboard::shift<up_right>(promoting) & victims };
+		while (promotions_left) {
+			int to64{ Bitboard::pop_bit(promotions_left) };
+			set_promotions<Color, false>(position, Board::squares64[to64 - up_left], Board::squares64[to64], position.piece_on(to64));
 		}
-	}
-}
-
-void MovesList::gen_whitepawnmoves_capt(const Board& position) noexcept {
-	constexpr int diag_right{ 11 };
-	constexpr int diag_left{ 9 };
-	constexpr int color{ Enums::W_PAWN };
-
-	for (int currpiece{}; currpiece < position.pieces_left_index(color); ++currpiece) {
-		int square{ position.pieces_list_index(color, currpiece) };
-
-		if (Board::square_exists(square + diag_left) &&
-			PieceInfo::get_piece_color(position.pieces_index(square + diag_left)) == Enums::BLACK) {
-			set_whitepawn_move(position, MoveUtils::gen_singlemove(square, square + diag_left, position.pieces_index(square + diag_left)));
+		while (promotions_right) {
+			int to64{ Bitboard::pop_bit(promotions_right) };
+			set_promotions<Color, false>(position, Board::squares64[to64 - up_right], Board::squares64[to64], position.piece_on(to64));
 		}
 
-		if (Board::square_exists(square + diag_right) &&
-			PieceInfo::get_piece_color(position.pieces_index(square + diag_right)) == Enums::BLACK) {
-			set_whitepawn_move(position, MoveUtils::gen_singlemove(square, square + diag_right, position.pieces_index(square + diag_right)));
-		}
+		int ep_square{ position.enPassant_square() };
+		if (ep_square != Enums::NO_SQUARE) {
+			int ep64{ Board::squares120[ep_square] };
+			// When evading, the captured pawn has to be the checker
+			if (Type == GenType::EVASIONS && !(targets & Bitboard::bitboard_setmask[ep64 - up])) return;
 
-		auto ep{ position.enPassant_square() };
-		if (ep != Enums::NO_SQUARE) {
-			if (square + diag_left == ep) {
-				set_epmove(position, MoveUtils::gen_singlemove(square, square + diag_left, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::enpassant));
-			}
-			if (square + diag_right != 99 && square + diag_right == ep) {
-				set_epmove(position, MoveUtils::gen_singlemove(square, square + diag_right, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::enpassant));
+			FAST_64UI capturers{ pawns & Attacks::pawn_attacks[Color ^ 1][ep64] };
+			while (capturers) {
+				set_epmove(position, MoveUtils::gen_singlemove(Board::squares64[Bitboard::pop_bit(capturers)], ep_square, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::enpassant));
 			}
 		}
 	}
 }
 
-void MovesList::gen_black_castle_moves(const Board& position) noexcept {
-	if ((position.castle_rights() & Enums::KING_SIDE_B) && position.pieces_index(Enums::F8) == Enums::NO_PIECE && position.pieces_index(Enums::G8) == Enums::NO_PIECE
-		&& !position.is_square_attacked(Enums::E8, Enums::WHITE) && !position.is_square_attacked(Enums::F8, Enums::WHITE)) {
-		set_quietmove(position, MoveUtils::gen_singlemove(Enums::E8, Enums::G8, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::castle));
-	}
-
-	if ((position.castle_rights() & Enums::QUEEN_SIDE_B) && position.pieces_index(Enums::D8) == Enums::NO_PIECE && position.pieces_index(Enums::C8) == Enums::NO_PIECE && position.pieces_index(Enums::B8) == Enums::NO_PIECE
-		&& !position.is_square_attacked(Enums::E8, Enums::WHITE) && !position.is_square_attacked(Enums::D8, Enums::WHITE)) {
-		set_quietmove(position, MoveUtils::gen_singlemove(Enums::E8, Enums::C8, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::castle));
+template<int Color, int PieceType>
+void MovesList::gen_piece_moves(const Board& position, FAST_64UI targets) noexcept {
+	FAST_64UI occupancy{ position.occupancy_index(Enums::NEITHER) };
+	FAST_64UI pieces_bb{ position.bitboards_index(PieceInfo::get_colored_piece(PieceType, Color)) };
+
+	while (pieces_bb) {
+		int square64{ Bitboard::pop_bit(pieces_bb) };
+		FAST_64UI attacks{};
+		if constexpr (PieceType == Enums::W_KNIGHT) attacks = Attacks::knight_attacks[square64];
+		else if constexpr (PieceType == Enums::W_BISHOP) attacks = Attacks::bishop_attacks(square64, occupancy);
+		else if constexpr (PieceType == Enums::W_ROOK) attacks = Attacks::rook_attacks(square64, occupancy);
+		else if constexpr (PieceType == Enums::W_QUEEN) attacks = Attacks::queen_attacks(square64, occupancy);
+		else attacks = Attacks::king_attacks[square64];
+		set_piece_moves<Color>(position, Board::squares64[square64], attacks & targets);
 	}
 }
 
-void MovesList::gen_white_castle_moves(const Board& position) noexcept {
-	// King side castle available
-	// No pieces between king-rook
-	// no squares between king-rook attacked
-	if ((position.castle_rights() & Enums::KING_SIDE_W) && position.pieces_index(Enums::F1) == Enums::NO_PIECE && position.pieces_index(Enums::G1) == Enums::NO_PIECE
-		&& !position.is_square_attacked(Enums::E1, Enums::BLACK) && !position.is_square_attacked(Enums::F1, Enums::BLACK)) {
-		set_quietmove(position, MoveUtils::gen_singlemove(Enums::E1, Enums::G1, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::castle));
+// No pieces between king and rook, and the king does not cross (or stand on) an attacked square
+template<int Color>
+void MovesList::gen_castle_moves(const Board& position) noexcept {
+	constexpr int enemy{ Color ^ 1 };
+	constexpr int rank_offset{ Color == Enums::WHITE ? 0 : Enums::A8 - Enums::A1 };
+	constexpr int king_side{ Color == Enums::WHITE ? Enums::KING_SIDE_W : Enums::KING_SIDE_B };
+	constexpr int queen_side{ Color == Enums::WHITE ? Enums::QUEEN_SIDE_W : Enums::QUEEN_SIDE_B };
+	constexpr int king{ Enums::E1 + rank_offset };
+
+	if ((position.castle_rights() & king_side) && position.pieces_index(Enums::F1 + rank_offset) == Enums::NO_PIECE && position.pieces_index(Enums::G1 + rank_offset) == Enums::NO_PIECE
+		&& !position.is_square_attacked(king, enemy) && !position.is_square_attacked(Enums::F1 + rank_offset, enemy)) {
+		set_quietmove(position, MoveUtils::gen_singlemove(king, Enums::G1 + rank_offset, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::castle));
 	}
 
-	if ((position.castle_rights() & Enums::QUEEN_SIDE_W) && position.pieces_index(Enums::D1) == Enums::NO_PIECE && position.pieces_index(Enums::C1) == Enums::NO_PIECE
-		&& position.pieces_index(Enums::B1) == Enums::NO_PIECE && !position.is_square_attacked(Enums::E1, Enums::BLACK) && !position.is_square_attacked(Enums::D1, Enums::BLACK)) {
-		set_quietmove(position, MoveUtils::gen_singlemove(Enums::E1, Enums::C1, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::castle));
+	if ((position.castle_rights() & queen_side) && position.pieces_index(Enums::D1 + rank_offset) == Enums::NO_PIECE && position.pieces_index(Enums::C1 + rank_offset) == Enums::NO_PIECE
+		&& position.pieces_index(Enums::B1 + rank_offset) == Enums::NO_PIECE && !position.is_square_attacked(king, enemy) && !position.is_square_attacked(Enums::D1 + rank_offset, enemy)) {
+		set_quietmove(position, MoveUtils::gen_singlemove(king, Enums::C1 + rank_offset, Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::castle));
 	}
 }
 
-void MovesList::gen_slide_moves(const Board& position, std::size_t piece_index) noexcept {
-	int piece{ PieceInfo::loop_slide[piece_index++] };
-
-	while (piece != Cnst::ZERO_PIECES) {
-		for (int currpiece{}; currpiece < position.pieces_left_index(piece); ++currpiece) {
-			int square{ position.pieces_list_index(piece, currpiece) };
-
-			for (int index{}; index < PieceInfo::get_tot_direction(piece); ++index) {
-				int direction{ PieceInfo::get_direction(piece, index) };
-				int temp_square{ square + direction };
-
-				while (Board::square_exists(temp_square)) {
-					if (position.pieces_index(temp_square) != Enums::NO_PIECE) {
-						if (PieceInfo::get_piece_color(position.pieces_index(temp_square)) == (position.turn() ^ 1)) {
-							set_tacticalmove(position, MoveUtils::gen_singlemove(square, temp_square, position.pieces_index(temp_square)));
-						}
-						break;
-					}
-					set_quietmove(position, MoveUtils::gen_singlemove(square, temp_square));
-					temp_square += direction;
-				}
-			}
-		}
-		piece = PieceInfo::loop_slide[piece_index++];
+// Appends the pseudo legal moves of the given type. checkers is only used by the evasions: in check, the king steps away,
+// and with a single checker the other pieces can also capture it or block on the squares between it and the king (never castling).
+template<int Color, MovesList::GenType Type>
+void MovesList::generate(const Board& position, FAST_64UI checkers) noexcept {
+	FAST_64UI own{ position.occupancy_index(Color) };
+	FAST_64UI targets{};
+
+	if constexpr (Type == GenType::EVASIONS) {
+		int king64{ Board::squares120[position.king_location_index(Color)] };
+		set_piece_moves<Color>(position, Board::squares64[king64], Attacks::king_attacks[king64] & ~own);
+		if (Bitboard::more_than_one(checkers)) return; // Double check: only the king can move
+		targets = Attacks::between_bb[king64][Utils::lsb(checkers)] | checkers;
+	}
+	else if constexpr (Type == GenType::CAPTURES) targets = position.occupancy_index(Color ^ 1);
+	else if constexpr (Type == GenType::QUIETS) targets = ~position.occupancy_index(Enums::NEITHER);
+	else targets = ~own;
+
+	gen_pawn_moves<Color, Type>(position, targets);
+	gen_piece_moves<Color, Enums::W_KNIGHT>(position, targets);
+	gen_piece_moves<Color, Enums::W_BISHOP>(position, targets);
+	gen_piece_moves<Color, Enums::W_ROOK>(position, targets);
+	gen_piece_moves<Color, Enums::W_QUEEN>(position, targets);
+
+	if constexpr (Type != GenType::EVASIONS) {
+		gen_piece_moves<Color, Enums::W_KING>(position, targets);
+		if constexpr (Type != GenType::CAPTURES) gen_castle_moves<Color>(position);
 	}
 }
 
-void MovesList::gen_slide_moves_capt(const Board& position, std::size_t piece_index) noexcept {
-	int piece{ PieceInfo::loop_slide[piece_index++] };
-
-	while (piece != Cnst::ZERO_PIECES) {
-		for (int currpiece{}; currpiece < position.pieces_left_index(piece); ++currpiece) {
-			int square{ position.pieces_list_index(piece, currpiece) };
-
-			for (int index{}; index < PieceInfo::get_tot_direction(piece); ++index) {
-				int direction{ PieceInfo::get_direction(piece, index) };
-				int temp_square{ square + direction };
-
-				while (Board::square_exists(temp_square)) {
-					if (position.pieces_index(temp_square) != Enums::NO_PIECE) {
-						if (PieceInfo::get_piece_color(position.pieces_index(temp_square)) == (position.turn() ^ 1)) {
-							set_tacticalmove(position, MoveUtils::gen_singlemove(square, temp_square, position.pieces_index(temp_square)));
-						}
-						break;
-					}
-					temp_square += direction;
-				}
-			}
-		}
-		piece = PieceInfo::loop_slide[piece_index++];
-	}
+void MovesList::generate_moves(const Board& position) noexcept {
+	assert(position.board_check());
+	tot_moves = 0;
+	if (position.turn() == Enums::WHITE) generate<Enums::WHITE, GenType::ALL>(position);
+	else generate<Enums::BLACK, GenType::ALL>(position);
+	commit();
 }
 
-void MovesList::gen_nonslide_moves(const Board& position, std::size_t piece_index) noexcept {
-	int piece{ PieceInfo::loop_nonslide[piece_index++] };
-	auto pieces_left{ position.pieces_left() };
-	auto pieces_list{ position.pieces_list() };
-	auto pieces{ position.pieces() };
-
-	while (piece != Cnst::ZERO_PIECES) {
-		for (int currpiece{}; currpiece < pieces_left[piece]; ++currpiece) {
-			int square{ pieces_list[piece][currpiece] };
-
-			for (int index{}; index < PieceInfo::get_tot_direction(piece); ++index) {
-				int direction{ PieceInfo::get_direction(piece, index) };
-				int temp_square{ square + direction };
-
-				if (!Board::square_exists(temp_square)) continue;
-				if (pieces[temp_square] != Enums::NO_PIECE) {
-					// There's a piece on the generated move -> capture
-					if (PieceInfo::get_piece_color(pieces[temp_square]) == (position.turn() ^ 1)) {
-						set_tacticalmove(position, MoveUtils::gen_singlemove(square, temp_square, pieces[temp_square]));
-					}
-					continue;
-				}
-				set_quietmove(position, MoveUtils::gen_singlemove(square, temp_square));
-			}
-		}
-		piece = PieceInfo::loop_nonslide[piece_index++];
-	}
+void MovesList::gen_captures_only(const Board& position) noexcept {
+	tot_moves = 0;
+	if (position.turn() == Enums::WHITE) generate<Enums::WHITE, GenType::CAPTURES>(position);
+	else generate<Enums::BLACK, GenType::CAPTURES>(position);
+	commit();
 }
 
-void MovesList::gen_nonslide_moves_capt(const Board& position, std::size_t piece_index) noexcept {
-	int piece{ PieceInfo::loop_nonslide[piece_index++] };
-	auto pieces_left{ position.pieces_left() };
-	auto pieces_list{ position.pieces_list() };
-	auto pieces{ position.pieces() };
-
-	while (piece != Cnst::ZERO_PIECES) {
-		for (int currpiece{}; currpiece < pieces_left[piece]; ++currpiece) {
-			int square{ pieces_list[piece][currpiece] };
-
-			for (int index{}; index < PieceInfo::get_tot_direction(piece); ++index) {
-				int direction{ PieceInfo::get_direction(piece, index) };
-				int temp_square{ square + direction };
-
-				if (!Board::square_exists(temp_square)) continue;
-				if (pieces[temp_square] != Enums::NO_PIECE) {
-					// There's a piece on the generated move -> capture
-					if (PieceInfo::get_piece_color(pieces[temp_square]) == (position.turn() ^ 1)) {
-						set_tacticalmove(position, MoveUtils::gen_singlemove(square, temp_square, pieces[temp_square]));
-					}
-					continue;
-				}
-			}
-		}
-		piece = PieceInfo::loop_nonslide[piece_index++];
-	}
+// Everything gen_captures_only leaves out: pawn pushes (promotions included), castling and the non capturing piece moves.
+// Like gen_quiet_checks it appends to the list, so that the quiet moves can follow the captures (see MovePicker)
+void MovesList::gen_quiets_only(const Board& position) noexcept {
+	if (position.turn() == Enums::WHITE) generate<Enums::WHITE, GenType::QUIETS>(position);
+	else generate<Enums::BLACK, GenType::QUIETS>(position);
+	commit();
 }
 
-void MovesList::set_whitepawn_move(const Boards::Board& position, int move, bool quiet) noexcept {
-	assert(Board::piece_exists(MoveUtils::get_capt(move)) && Board::square_exists(MoveUtils::get_from(move))
-		&& Board::square_exists(MoveUtils::get_to(move)));
-	auto cap{ MoveUtils::get_capt(move) };
-	auto to{ MoveUtils::get_to(move) };
-	auto from{ MoveUtils::get_from(move) };
-
-	if (quiet) {
-		if (Board::get_rank[from] == Enums::RANK7) { // Move is promotion
-			set_quietmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::W_QUEEN));
-			set_quietmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::W_ROOK));
-			set_quietmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::W_BISHOP));
-			set_quietmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::W_KNIGHT));
-		}
-		else {
-			set_quietmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::NO_PIECE));
-		}
-	}
+// Only called when the side to move is in check (checkers = position.checkers())
+void MovesList::gen_evasions(const Board& position, FAST_64UI checkers) noexcept {
+	tot_moves = 0;
+	if (position.turn() == Enums::WHITE) generate<Enums::WHITE, GenType::EVASIONS>(position, checkers);
+	else generate<Enums::BLACK, GenType::EVASIONS>(position, checkers);
+	commit();
+}
 
-	else {
-		if (Board::get_rank[from] == Enums::RANK7) { // Move is promotion
-			set_tacticalmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::W_QUEEN));
-			set_tacticalmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::W_ROOK));
-			set_tacticalmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::W_BISHOP));
-			set_tacticalmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::W_KNIGHT));
-		}
-		else {
-			set_tacticalmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::NO_PIECE));
-		}
-	}
+// Quiet moves that give check, either directly or by discovery. Promotions are left out (they are not quiet moves for the quiescence),
+// and so is castling. Unlike the other generators this one appends to the list, so that it can follow gen_captures_only.
+void MovesList::gen_quiet_checks(const Board& position) noexcept {
+	if (position.turn() == Enums::WHITE) generate_quiet_checks<Enums::WHITE>(position);
+	else generate_quiet_checks<Enums::BLACK>(position);
+	commit();
 }
 
-void MovesList::set_blackpawn_move(const Boards::Board& position, int move, bool quiet) noexcept {
-	assert(Board::piece_exists(MoveUtils::get_capt(move)) && Board::square_exists(MoveUtils::get_from(move))
-		&& Board::square_exists(MoveUtils::get_to(move)));
-	auto cap{ MoveUtils::get_capt(move) };
-	auto to{ MoveUtils::get_to(move) };
-	auto from{ MoveUtils::get_from(move) };
-
-	if (quiet) {
-		if (Board::get_rank[from] == Enums::RANK2) { // Move is promotion
-			set_quietmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::B_QUEEN));
-			set_quietmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::B_ROOK));
-			set_quietmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::B_BISHOP));
-			set_quietmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::B_KNIGHT));
-		}
-		else {
-			set_quietmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::NO_PIECE));
-		}
+template<int Color>
+void MovesList::generate_quiet_checks(const Board& position) noexcept {
+	constexpr int up{ Color == Enums::WHITE ? 8 : -8 };
+	constexpr FAST_64UI double_push_rank{ Bitboard::rank_mask(Color == Enums::WHITE ? Enums::RANK3 : Enums::RANK6) }; // After the first step
+	constexpr FAST_64UI promotion_rank{ Bitboard::rank_mask(Color == Enums::WHITE ? Enums::RANK7 : Enums::RANK2) };    // Before promoting
+
+	int enemy_king64{ Board::squares120[position.king_location_index(Color ^ 1)] };
+	FAST_64UI occupancy{ position.occupancy_index(Enums::NEITHER) };
+	FAST_64UI discovers{ position.blockers_index(Color ^ 1) & position.occupancy_index(Color) };
+
+	// A pawn push stays on its file, so a discovering pawn checks with any push unless it shields the king along that file
+	FAST_64UI pawns{ position.pawns_index(Color) & ~promotion_rank };
+	FAST_64UI discovering_pawns{ pawns & discovers & ~(Bitboard::FILE_A_MASK << (enemy_king64 % 8)) };
+	FAST_64UI pawn_checks{ position.check_squares_index(Enums::W_PAWN) };
+
+	FAST_64UI single{ Bitboard::shift<up>(pawns) & ~occupancy };
+	FAST_64UI doubles{ Bitboard::shift<up>(single & double_push_rank) & ~occupancy };
+	single &= pawn_checks | Bitboard::shift<up>(discovering_pawns);
+	doubles &= pawn_checks | Bitboard::shift<up>(Bitboard::shift<up>(discovering_pawns));
+
+	while (single) {
+		int to64{ Bitboard::pop_bit(single) };
+		set_quietmove(position, MoveUtils::gen_singlemove(Board::squares64[to64 - up], Board::squares64[to64]));
 	}
-	else {
-		if (Board::get_rank[from] == Enums::RANK2) { // Move is promotion
-			set_tacticalmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::B_QUEEN));
-			set_tacticalmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::B_ROOK));
-			set_tacticalmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::B_BISHOP));
-			set_tacticalmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::B_KNIGHT));
-		}
-		else {
-			set_tacticalmove(position, MoveUtils::gen_singlemove(from, to, cap, Enums::NO_PIECE));
-		}
+	while (doubles) {
+		int to64{ Bitboard::pop_bit(doubles) };
+		set_quietmove(position, MoveUtils::gen_singlemove(Board::squares64[to64 - up - up], Board::squares64[to64], Enums::NO_PIECE, Enums::NO_PIECE, MoveUtils::pawnfirst));
 	}
-}
-
-void MovesList::generate_moves(const Board& position) noexcept {
-	assert(position.board_check());
-	tot_moves = 0;
-	int turn{ position.turn() };
 
-	if (turn == Enums::WHITE) {
-		gen_whitepawnmove(position);
-		gen_white_castle_moves(position);
-		gen_slide_moves(position, 0);
-		gen_nonslide_moves(position, 0);
-	}
-	else {
-		gen_blackpawnmoves(position);
-		gen_black_castle_moves(position);
-		gen_slide_moves(position, 4);
-		gen_nonslide_moves(position, 3);
+	for (int type{ Enums::W_KNIGHT }; type <= Enums::W_KING; ++type) {
+		int piece{ PieceInfo::get_colored_piece(type, Color) };
+		FAST_64UI pieces_bb{ position.bitboards_index(piece) };
+		if (type == Enums::W_KING) pieces_bb &= discovers;
+
+		while (pieces_bb) {
+			int square64{ Bitboard::pop_bit(pieces_bb) };
+			FAST_64UI targets{ type == Enums::W_KNIGHT || type == Enums::W_KING
+				? Attacks::nonslide_attacks(piece, square64) & ~occupancy
+				: Attacks::slide_attacks(piece, square64, occupancy) & ~occupancy };
+
+			// A discovering piece checks by leaving the line to the king, otherwise it has to land on a checking square
+			// (the king never checks directly, so it only gets here as a discovering piece)
+			FAST_64UI check_squares{ type == Enums::W_KING ? 0ULL : position.check_squares_index(type) };
+			if (discovers & Bitboard::bitboard_setmask[square64]) targets &= ~Attacks::line_bb[square64][enemy_king64] | check_squares;
+			else targets &= check_squares;
+
+			while (targets) {
+				set_quietmove(position, MoveUtils::gen_singlemove(Board::squares64[square64], Board::squares64[Bitboard::pop_bit(targets)]));
+			}
+		}
 	}
 }
 
-void MovesList::gen_captures_only(const Board& position) noexcept {
-	tot_moves = 0;
-	if (position.turn() == Enums::WHITE) {
-		gen_whitepawnmoves_capt(position);
-		gen_slide_moves_capt(position, 0);
-		gen_nonslide_moves_capt(position, 0);
-	}
-	else {
-		gen_blackpawnmoves_capt(position);
-		gen_slide_moves_capt(position, 4);
-		gen_nonslide_moves_capt(position, 3);
+void MovesList::remove_illegal_moves(const Board& position) noexcept {
+	// Keeps the generation order of the legal moves
+	std::size_t legal_moves{};
+	for (std::size_t index{}; index < tot_moves; ++index) {
+		if (position.is_legal(all_moves[index].move)) {
+			all_moves[legal_moves++] = all_moves[index];
+		}
 	}
+	tot_moves = legal_moves;
+	commit();
 }
 
-[[nodiscard]] bool MovesList::move_check(Boards::Board& board, int move) noexcept {
-	// Sanity check in case two positions have the same zobrist key
-	generate_moves(board);
-	for (int curr{}; curr < tot_moves; ++curr) {
-		if (!board.make_move(all_moves[curr].move)) continue;
-		board.unmake_move();
-		if (all_moves[curr].move == move) return true;
-	}
-	return false;
+void MovesList::generate_legal_moves(const Board& position) noexcept {
+	FAST_64UI checkers{ position.checkers() };
+	if (checkers) gen_evasions(position, checkers);
+	else generate_moves(position);
+	remove_illegal_moves(position);
 }
 
 
+
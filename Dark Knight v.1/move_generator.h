@@ -6,6 +6,8 @@
 #include "piece_info.h"
 #include "board.h"
 #include <array>
+#include <span>
+#include <cstdlib>
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 // This file contains all move related generations (pawns, sliding and non sliding pieces) 
@@ -44,6 +46,27 @@ namespace MoveUtils {
 	[[nodiscard]] static constexpr __forceinline bool is_castle(int move)    noexcept { return move & castle; }
 	[[nodiscard]] static constexpr __forceinline bool is_enpassant(int move) noexcept { return move & enpassant; }
 
+	// Compact moves (COMPACT_MOVE) are stored by the transposition table, the killers and the principal variation:
+	// from64 bits 0-5, to64 bits 6-11, promoted piece type bits 12-13 (knight to queen), special move bits 14-15.
+	// The captured piece and the pawn first move flag are recovered from the board, see Board::expand_move
+	constexpr inline int compact_promotion{ 0x4000 };
+	constexpr inline int compact_enpassant{ 0x8000 };
+	constexpr inline int compact_castle{ 0xC000 };
+	constexpr inline int compact_special{ 0xC000 };
+
+	[[nodiscard]] static constexpr __forceinline int get_compact_from(COMPACT_MOVE move) noexcept { return move & 0x3F; }
+	[[nodiscard]] static constexpr __forceinline int get_compact_to(COMPACT_MOVE move)   noexcept { return (move >> 6) & 0x3F; }
+	[[nodiscard]] static constexpr __forceinline int get_compact_prom(COMPACT_MOVE move) noexcept { return Enums::W_KNIGHT + ((move >> 12) & 0x3); } // White piece
+
+	[[nodiscard]] static constexpr __forceinline COMPACT_MOVE compress(int move) noexcept {
+		if (move == Enums::INCORRECT_MOVE) return 0;
+		int compact{ Boards::Board::squares120[get_from(move)] | Boards::Board::squares120[get_to(move)] << 6 };
+		if (is_promotion(move)) compact |= compact_promotion | ((get_prom(move) - 1) % 6 - 1) << 12;
+		else if (is_enpassant(move)) compact |= compact_enpassant;
+		else if (is_castle(move)) compact |= compact_castle;
+		return static_cast<COMPACT_MOVE>(compact);
+	}
+
 	[[nodiscard]] constexpr int get_castle_perm(int castle_index) noexcept {
 		switch (castle_index) {
 			case Enums::CastlePermissions::BROOK_QUEENSIDE: return Enums::BLACK_NOCASTLE_QUEENSIDE;
@@ -75,31 +98,56 @@ public:
 	};
 
 private:
-	std::array<Move, Cnst::MAX_POS_MOVES> all_moves{};
+	// Moves of every list alive in the current thread, one slice after the other: a list starts where the previous one ends
+	// and gives its slice back when it goes out of scope (lists always die in the reverse order of their creation,
+	// and only the most recent one generates moves)
+	// Search::alpha_beta and Search::quiescence return before building their picker past ply MAX_DEPTH - 1, so a search
+	// holds at most MAX_DEPTH lists at once; two more slices are left for the lists built outside the search (uci, perft)
+	constexpr static inline std::size_t MAX_LISTS{ Cnst::MAX_DEPTH + 2 };
+	constexpr static inline std::size_t ARENA_SIZE{ MAX_LISTS * Cnst::MAX_POS_MOVES };
+	static_assert(MAX_LISTS > Cnst::MAX_DEPTH, "the arena must hold one list per searched ply");
+	static thread_local std::array<Move, ARENA_SIZE> arena;
+	static thread_local std::size_t arena_top;
+
+	Move* all_moves{ arena.data() + arena_top };
 	std::size_t tot_moves{};
 
+	// Moves the top of the arena after the moves generated so far
+	__forceinline void commit() noexcept {
+		arena_top = static_cast<std::size_t>(all_moves - arena.data()) + tot_moves;
+	}
+
 
 public:
 	using Board = Boards::Board;
+	// A new list always gets a whole free slice before anything is generated into it (also checked in release builds)
+	MovesList() noexcept {
+		if (arena_top + Cnst::MAX_POS_MOVES > ARENA_SIZE) std::abort();
+	}
+	MovesList(const MovesList&) = delete;
+	MovesList& operator=(const MovesList&) = delete;
+	~MovesList() { arena_top = static_cast<std::size_t>(all_moves - arena.data()); }
+
 	constexpr __forceinline const auto& operator[](std::size_t index) const noexcept { return all_moves[index]; }
 	constexpr __forceinline auto& operator[](std::size_t index) noexcept { return all_moves[index]; }
 
-	// Pawns
-	void set_whitepawn_move(const Board& position, int move, bool quiet = false) noexcept;
-	void set_blackpawn_move(const Board& position, int move, bool quiet = false) noexcept;
-	void gen_blackpawnmoves(const Boards::Board& position, bool quiet = true) noexcept;
-	void gen_whitepawnmove(const Board& position, bool quiet = true) noexcept;
-
-	// Slide: Bishop, Rook, Queen -- Non slide: Knight, king
-	void gen_slide_moves(const Board& position, std::size_t piece_index) noexcept;
-	void gen_nonslide_moves(const Board& position, std::size_t piece_index) noexcept;
-
-	// Castle 
-	void gen_black_castle_moves(const Board& position) noexcept;
-	void gen_white_castle_moves(const Board& position) noexcept;
+	// Generation type, every generator below is specialized at compile time on it and on the side to move
+	enum class GenType { ALL, CAPTURES, QUIETS, EVASIONS };
 
 	// All moves
 	void generate_moves(const Board& position) noexcept;
+	void gen_captures_only(const Board& position) noexcept;
+	void gen_quiets_only(const Board& position) noexcept; // Appends, see MovePicker
+
+	// Check evasions (checkers = position.checkers(), must not be empty)
+	void gen_evasions(const Board& position, FAST_64UI checkers) noexcept;
+
+	// Quiet moves giving check (appended to the current list, see Search::quiescence)
+	void gen_quiet_checks(const Board& position) noexcept;
+
+	// Legal moves only: the pseudo legal moves are filtered with the pins and checkers of the position, computed once
+	void generate_legal_moves(const Board& position) noexcept;
+	void remove_illegal_moves(const Board& position) noexcept;
 
 	// Move type
 	constexpr void set_quietmove(const Boards::Board& position, int move) noexcept;
@@ -116,33 +164,33 @@ public:
 		return tot_moves;
 	}
 
-	[[nodiscard]] __forceinline constexpr const auto& get_all_moves() const noexcept {
-		return all_moves;
+	[[nodiscard]] __forceinline constexpr std::span<const Move> get_all_moves() const noexcept {
+		return { all_moves, tot_moves };
 	}
 
-	// Sanity checks
-	[[nodiscard]] bool move_check(Boards::Board& board, int move) noexcept;
-
 	__forceinline constexpr void set_score(int move_num, int new_score) noexcept {
 		all_moves[move_num].score = new_score;
 	}
 
-	void gen_captures_only(const Board& pos) noexcept;
-	void gen_blackpawnmoves_capt(const Board& position) noexcept;
-	void gen_whitepawnmoves_capt(const Board& position) noexcept;
-	void gen_slide_moves_capt(const Board& position, std::size_t piece_index) noexcept;
-	void gen_nonslide_moves_capt(const Board& position, std::size_t piece_index) noexcept;
+private:
+	template<int Color, GenType Type> void generate(const Board& position, FAST_64UI checkers = 0) noexcept;
+	template<int Color, GenType Type> void gen_pawn_moves(const Board& position, FAST_64UI targets) noexcept;
+	template<int Color, int PieceType> void gen_piece_moves(const Board& position, FAST_64UI targets) noexcept; // Knight, bishop, rook, queen or king
+	template<int Color> void gen_castle_moves(const Board& position) noexcept;
+	template<int Color> void generate_quiet_checks(const Board& position) noexcept;
+
+	template<int Color, bool Quiet> void set_promotions(const Board& position, int from, int to, int captured) noexcept;
+	template<int Color> void set_piece_moves(const Board& position, int square, FAST_64UI targets) noexcept; // targets: 64-square bitboard, captures and quiets
 };
 
+inline thread_local std::array<MovesList::Move, MovesList::ARENA_SIZE> MovesList::arena{};
+inline thread_local std::size_t MovesList::arena_top{};
+
 constexpr void MovesList::set_quietmove(const Boards::Board& position, int move) noexcept {
-	all_moves[tot_moves].move = move;
-	if (position.killer_moves_index(0, position.ply()) == move) {
-		all_moves[tot_moves].score = Enums::KILLER_FIRST;
-	}
-	else if (position.killer_moves_index(1, position.ply()) == move) {
-		all_moves[tot_moves].score = Enums::KILLER_SECOND;
-	}
-	else all_moves[tot_moves].score = position.search_heuristics_index(position.pieces_index(MoveUtils::get_from(move)), MoveUtils::get_to(move));
+	// Scored by history only: the killers are placed by MovePicker, which expands them once per node
+	all_moves[tot_moves] = {
+		move, position.search_heuristics_index(position.pieces_index(MoveUtils::get_from(move)), MoveUtils::get_to(move))
+	};
 	++tot_moves;
 }
 
@@ -0,0 +1,153 @@
+#include "move_picker.h"
+#include "piece_info.h"
+#include "bitboard.h"
+#include <utility>
+
+MovePicker::MovePicker(const Board& position, int tt_move) noexcept
+	: m_position{ position }, m_checkers{ position.checkers() }, m_tt_move{ tt_move } {
+	m_stage = m_checkers ? Stage::EVASION_TT_MOVE : Stage::TT_MOVE;
+	m_killers = { position.expand_move(position.killer_moves_index(0, position.ply())), position.expand_move(position.killer_moves_index(1, position.ply())) };
+}
+
+MovePicker::MovePicker(const Board& position, bool quiet_checks, int tt_move) noexcept
+	: m_position{ position }, m_checkers{ position.checkers() }, m_tt_move{ tt_move }, m_quiet_checks{ quiet_checks } {
+	m_stage = m_checkers ? Stage::EVASION_TT_MOVE : Stage::QS_TT_MOVE;
+	// Out of check a quiet transposition move is not searched here (MoveUtils::capture also covers en passant)
+	if (!m_checkers && !(tt_move & MoveUtils::capture)) m_tt_move = Enums::INCORRECT_MOVE;
+	if (m_checkers) m_killers = { position.expand_move(position.killer_moves_index(0, position.ply())), position.expand_move(position.killer_moves_index(1, position.ply())) };
+}
+
+// Lazy selection sort: only the moves actually searched get sorted
+[[nodiscard]] int MovePicker::select_best(std::size_t end) noexcept {
+	std::size_t best{ m_current };
+	for (std::size_t index{ m_current + 1 }; index < end; ++index) {
+		if (m_moves[index].score > m_moves[best].score) best = index;
+	}
+	std::swap(m_moves[m_current], m_moves[best]);
+	return m_moves[m_current++].move;
+}
+
+[[nodiscard]] bool MovePicker::is_valid(int move) const noexcept {
+	return m_position.is_pseudo_legal(move) && m_position.is_legal(move);
+}
+
+[[nodiscard]] int MovePicker::next_move() noexcept {
+	switch (m_stage) {
+		case Stage::TT_MOVE:
+			m_stage = Stage::GEN_CAPTURES;
+			if (is_valid(m_tt_move)) return m_tt_move;
+			[[fallthrough]];
+
+		case Stage::GEN_CAPTURES:
+			m_moves.gen_captures_only(m_position);
+			m_end_captures = m_moves.get_tot_moves();
+			m_stage = Stage::GOOD_CAPTURES;
+			[[fallthrough]];
+
+		case Stage::GOOD_CAPTURES:
+			while (m_current < m_end_captures) {
+				int move{ select_best(m_end_captures) };
+				if (move == m_tt_move || !m_position.is_legal(move)) continue;
+				if (!m_position.see_ge(move, 0)) { // Losing captures are tried last
+					m_moves[m_end_bad_captures++] = m_moves[m_current - 1];
+					continue;
+				}
+				return move;
+			}
+			m_stage = Stage::KILLERS;
+			[[fallthrough]];
+
+		case Stage::KILLERS:
+			// Killers are quiet moves (no captured piece), so they can only be played if their target square is still empty
+			while (m_killer_index < m_killers.size()) {
+				int move{ m_killers[m_killer_index++] };
+				if (move & MoveUtils::capture || move == m_tt_move || (m_killer_index == 2 && move == m_killers[0])) continue;
+				if (is_valid(move)) return move;
+			}
+			m_stage = Stage::GEN_QUIETS;
+			[[fallthrough]];
+
+		case Stage::GEN_QUIETS:
+			// Scored by history only now that they are needed
+			m_moves.gen_quiets_only(m_position);
+			m_stage = Stage::QUIETS;
+			[[fallthrough]];
+
+		case Stage::QUIETS:
+			while (m_current < m_moves.get_tot_moves()) {
+				int move{ select_best(m_moves.get_tot_moves()) };
+				if (move != m_tt_move && move != m_killers[0] && move != m_killers[1] && m_position.is_legal(move)) return move;
+			}
+			m_current = 0;
+			m_stage = Stage::BAD_CAPTURES;
+			[[fallthrough]];
+
+		case Stage::BAD_CAPTURES:
+			if (m_current < m_end_bad_captures) return m_moves[m_current++].move; // Already checked for legality
+			m_stage = Stage::DONE;
+			return Enums::INCORRECT_MOVE;
+
+		case Stage::EVASION_TT_MOVE:
+			m_stage = Stage::GEN_EVASIONS;
+			if (is_valid(m_tt_move)) return m_tt_move;
+			[[fallthrough]];
+
+		case Stage::GEN_EVASIONS:
+			m_moves.gen_evasions(m_position, m_checkers);
+			// Quiet evasions that are killers go right after the captures
+			for (std::size_t index{}; index < m_moves.get_tot_moves(); ++index) {
+				if (m_moves[index].move == m_killers[0]) m_moves[index].score = Enums::KILLER_FIRST;
+				else if (m_moves[index].move == m_killers[1]) m_moves[index].score = Enums::KILLER_SECOND;
+			}
+			m_stage = Stage::EVASIONS;
+			[[fallthrough]];
+
+		case Stage::EVASIONS:
+			while (m_current < m_moves.get_tot_moves()) {
+				int move{ select_best(m_moves.get_tot_moves()) };
+				if (move != m_tt_move && m_position.is_legal(move)) return move;
+			}
+			m_stage = Stage::DONE;
+			return Enums::INCORRECT_MOVE;
+
+		case Stage::QS_TT_MOVE:
+			m_stage = Stage::QS_GEN_CAPTURES;
+			if (is_valid(m_tt_move)) return m_tt_move;
+			[[fallthrough]];
+
+		case Stage::QS_GEN_CAPTURES:
+			m_moves.gen_captures_only(m_position);
+			m_end_captures = m_moves.get_tot_moves();
+			m_stage = Stage::QS_CAPTURES;
+			[[fallthrough]];
+
+		case Stage::QS_CAPTURES:
+			while (m_current < m_end_captures) {
+				int move{ select_best(m_end_captures) };
+				if (move != m_tt_move && m_position.is_legal(move)) return move;
+			}
+			if (!m_quiet_checks) {
+				m_stage = Stage::DONE;
+				return Enums::INCORRECT_MOVE;
+			}
+			m_stage = Stage::QS_GEN_CHECKS;
+			[[fallthrough]];
+
+		case Stage::QS_GEN_CHECKS:
+			m_moves.gen_quiet_checks(m_position);
+			m_stage = Stage::QS_CHECKS;
+			[[fallthrough]];
+
+		case Stage::QS_CHECKS:
+			while (m_current < m_moves.get_tot_moves()) {
+				int move{ select_best(m_moves.get_tot_moves()) };
+				if (m_position.is_legal(move)) return move;
+			}
+			m_stage = Stage::DONE;
+			[[fallthrough]];
+
+		case Stage::DONE:
+		default:
+			return Enums::INCORRECT_MOVE;
+	}
+}
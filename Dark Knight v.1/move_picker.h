@@ -0,0 +1,51 @@
+#ifndef MOVE_PICKER_H
+#define MOVE_PICKER_H
+
+#include "utilities.h"
+#include "move_generator.h"
+#include <array>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// Staged move picker used by the search: moves are generated and ordered only when needed,
+// so that a cutoff on the transposition move or on a capture skips the rest of the work.
+// Order: transposition move, good captures (MVV-LVA, not losing by Board::see_ge), killers, quiet moves (by history), bad captures.
+// The transposition move and the killers are checked with Board::is_pseudo_legal, without any generation.
+// In check every evasion is generated at once; the quiescence only goes through the transposition move if it is a capture,
+// then the captures (and, at its first ply, the quiet checks).
+// Every move returned is legal; Enums::INCORRECT_MOVE is returned once there is nothing left.
+///////////////////////////////////////////////////////////////////////////////////////////
+
+class MovePicker {
+public:
+	using Board = Boards::Board;
+
+	enum class Stage {
+		TT_MOVE, GEN_CAPTURES, GOOD_CAPTURES, KILLERS, GEN_QUIETS, QUIETS, BAD_CAPTURES,
+		EVASION_TT_MOVE, GEN_EVASIONS, EVASIONS,
+		QS_TT_MOVE, QS_GEN_CAPTURES, QS_CAPTURES, QS_GEN_CHECKS, QS_CHECKS,
+		DONE
+	};
+
+	MovePicker(const Board& position, int tt_move) noexcept;				// Main search
+	MovePicker(const Board& position, bool quiet_checks, int tt_move) noexcept;	// Quiescence
+
+	[[nodiscard]] int next_move() noexcept;
+
+private:
+	[[nodiscard]] int select_best(std::size_t end) noexcept;
+	[[nodiscard]] bool is_valid(int move) const noexcept;
+
+	const Board& m_position;
+	MovesList m_moves;
+	FAST_64UI m_checkers{};
+	std::size_t m_current{};
+	std::size_t m_end_captures{};
+	std::size_t m_end_bad_captures{}; // Bad captures are moved to the front of the list, over the moves already returned
+	int m_tt_move{ Enums::INCORRECT_MOVE };
+	std::array<int, 2> m_killers{};
+	std::size_t m_killer_index{};
+	bool m_quiet_checks{};
+	Stage m_stage{};
+};
+
+#endif
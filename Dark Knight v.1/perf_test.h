@@ -5,6 +5,7 @@
 #include "move_generator.h"
 #include "board.h"
 #include "print.h"
+#include "boardKey_generator.h"
 
 #include <iostream>
 #include <fstream>
@@ -15,30 +16,54 @@
 #include <chrono> 
 
 
+// Moves whose key predicted by Board::key_after differs from the incremental key or from a full recomputation
+inline FAST_64UI perft_key_errors{};
+
+inline void check_key_after(FAST_64UI predicted, const Boards::Board& board) noexcept {
+    if (predicted != board.position_key() || predicted != HashGenerator::key_generator(board)) ++perft_key_errors;
+}
+
 inline FAST_64UI perft(int depth, Boards::Board& board) noexcept {
     if (!depth) return 1;
 
     FAST_64UI leaf_nodes{};
     MovesList movelist;
-    movelist.generate_moves(board);
+    movelist.generate_legal_moves(board);
+    if (depth == 1) return movelist.get_tot_moves(); // Every generated move is legal: no need to play the last ply
 
     for (int index{}; index < movelist.get_tot_moves(); ++index) {
-        if (!board.make_move(movelist[index].move)) continue;
+        board.make_legal_move(movelist[index].move);
         leaf_nodes += perft(depth - 1, board);
         board.unmake_move();
     }
     return leaf_nodes;
 }
 
+// Same walk as perft, checking the key of every position it plays into; kept apart so perft only times move generation and make/unmake
+inline void perft_verify(int depth, Boards::Board& board) noexcept {
+    if (!depth) return;
+
+    MovesList movelist;
+    movelist.generate_legal_moves(board);
+    for (std::size_t index{}; index < movelist.get_tot_moves(); ++index) {
+        int move{ movelist[index].move };
+        FAST_64UI predicted{ board.key_after(move) };
+        board.make_legal_move(move);
+        check_key_after(predicted, board);
+        perft_verify(depth - 1, board);
+        board.unmake_move();
+    }
+}
+
 inline FAST_64UI perft_test(int depth, Boards::Board& board) noexcept {
     MovesList movelist;
     FAST_64UI tot_nodes{};
 
     auto clockbegin{ std::chrono::high_resolution_clock::now() };
-    movelist.generate_moves(board);
+    movelist.generate_legal_moves(board);
     for (int index{}; index < movelist.get_tot_moves(); ++index) {
         int move{ movelist[index].move };
-        if (!board.make_move(move)) continue;
+        board.make_legal_move(move);
         FAST_64UI nodes{ perft(depth - 1, board) };
         tot_nodes += nodes;
         board.unmake_move();
@@ -88,9 +113,12 @@ inline bool exec_perft_tests(const Boards::Board& board, int depth) {
 
     for (std::size_t index{}; const auto & x : perft_cases) {
         b.parse_fen(x.first.c_str());
+        perft_key_errors = 0;
         auto nodes_found = perft_test(depth, b);
+        perft_verify(depth, b);
         std::cout << "x second: " << x.second << std::endl;
-        if (nodes_found == x.second) {
+        if (perft_key_errors) std::cerr << "Wrong key after " << perft_key_errors << " moves" << '\n';
+        if (nodes_found == x.second && !perft_key_errors) {
             SetConsoleTextAttribute(hConsole, 2);
             std::cout << "Perft case [" << index << "] PASSED" << '\n';
         }
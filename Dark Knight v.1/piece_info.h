@@ -10,35 +10,6 @@
 
 
 namespace PieceInfo {
-	enum GeneralDirections {
-		left = -1, up = -10, right = 1, down = 10, upright = -9,
-		upleft = -11, downright = 11, downleft = 9
-	};
-
-	// Lookup for slide/non slide pieces
-	constexpr inline std::array<int, 8> loop_slide{
-	Enums::W_BISHOP, Enums::W_ROOK, Enums::W_QUEEN, Cnst::ZERO_PIECES, Enums::B_BISHOP, Enums::B_ROOK, Enums::B_QUEEN, Cnst::ZERO_PIECES
-	};
-
-	constexpr inline std::array<int, 6> loop_nonslide{
-	 Enums::W_KNIGHT, Enums::W_KING, Cnst::ZERO_PIECES, Enums::B_KNIGHT, Enums::B_KING, Cnst::ZERO_PIECES
-	};
-
-	constexpr inline std::array<int, 8> get_slide_piece{
-		Enums::W_BISHOP, Enums::W_ROOK, Enums::W_QUEEN, Cnst::ZERO_PIECES, Enums::B_BISHOP, Enums::B_ROOK, Enums::B_QUEEN, Cnst::ZERO_PIECES
-	};
-
-	constexpr inline std::array<int, 6> get_notslide_piece{
-		Enums::W_KNIGHT, Enums::W_KING, Cnst::ZERO_PIECES, Enums::B_KNIGHT, Enums::B_KING, Cnst::ZERO_PIECES
-	};
-
-
-	// Lookup tables 
-	constexpr inline std::array<int, 8> kingqueen_attacks{ left, up, right, down, upright, upleft, downright, downleft };
-	constexpr inline std::array<int, 4> rook_attacks{ left, up, right, down };
-	constexpr inline std::array<int, 4> bishop_attacks{ upright, upleft, downright, downleft };
-	constexpr inline std::array<int, 8> knight_attacks{ -8, -19, -21, -12, 8, 19, 21, 12 };
-
 	// Most valuable victim, least valuable aggressor
 	// 0 to account for Enums::NO_PIECE
 	constexpr inline std::array<std::array<int, 13>, 13> mvv_lva{ {
@@ -58,14 +29,6 @@ namespace PieceInfo {
 		{ 0, 605, 604, 603, 602, 601, 600,	605, 604, 603, 602, 601, 600 },
 	} };
 
-	[[nodiscard]] static constexpr __forceinline int get_tot_direction(int piece) noexcept {
-		switch (piece) {
-			case Enums::NO_PIECE: case Enums::W_PAWN: case Enums::B_PAWN: return 0;
-			case Enums::W_ROOK: case Enums::B_ROOK: case Enums::W_BISHOP: case Enums::B_BISHOP: return 4;
-			default: return 8;
-		}
-	}
-
 	[[nodiscard]] static constexpr __forceinline bool is_piece_big(int piece) noexcept {
 		return (1 << piece) & 0b1111101111100;
 	}
@@ -114,21 +77,9 @@ namespace PieceInfo {
 		return (1 << piece) & 0b0111000111000;
 	}
 
-	[[nodiscard]] static constexpr int get_direction(int piece, std::size_t index) noexcept {
-		assert(piece >= 0 && piece <= 13 && (index >= 0 && index <= 8));
-
-		switch (piece) {
-			case Enums::NO_PIECE: case Enums::W_PAWN: case Enums::B_PAWN: return 0;
-			case Enums::B_KING: case Enums::W_KING:
-			case Enums::B_QUEEN: case Enums::W_QUEEN:
-				return kingqueen_attacks[index];
-			case Enums::B_ROOK: case Enums::W_ROOK:
-				return rook_attacks[index];
-			case Enums::B_KNIGHT: case Enums::W_KNIGHT:
-				return knight_attacks[index];
-			default:
-				return bishop_attacks[index];
-			}
+	// Given a white piece (e.g Enums::W_KNIGHT) returns the same piece type of the given color
+	[[nodiscard]] static constexpr __forceinline int get_colored_piece(int white_piece, int color) noexcept {
+		return white_piece + color * 6;
 	}
 
 	[[nodiscard]] static constexpr char get_promoted_piece(int piece) noexcept {
@@ -51,6 +51,12 @@ namespace Print {
 		}
 	}
 
+	// Only the squares and the promoted piece are printed, so a compact move needs no board
+	[[nodiscard]] inline std::string get_stringmove(COMPACT_MOVE m) noexcept {
+		int promoted{ (m & MoveUtils::compact_special) == MoveUtils::compact_promotion ? MoveUtils::get_compact_prom(m) : Enums::NO_PIECE };
+		return get_stringmove(MoveUtils::gen_singlemove(Boards::Board::squares64[MoveUtils::get_compact_from(m)], Boards::Board::squares64[MoveUtils::get_compact_to(m)], Enums::NO_PIECE, promoted));
+	}
+
 	inline void print_attacked(Enums::Color side, const Boards::Board& pos) noexcept {
 		std::cout << "\n\nSquares attacked by: " << Cnst::side_str[side];
 		for (int rank{ Enums::RANK8 }; rank >= Enums::RANK1; --rank) {
@@ -79,9 +85,9 @@ namespace Print {
 		int to_sq64{ Utils::getSquare64(move_str[2] - 'a', move_str[3] - '1') };
 
 		MovesList moves;
-		moves.generate_moves(position);
-		for (auto& current_move : moves.get_all_moves()) {
-			int move{ current_move.move };
+		moves.generate_legal_moves(position);
+		for (std::size_t index{}; index < moves.get_tot_moves(); ++index) {
+			int move{ moves[index].move };
 			if (MoveUtils::get_from(move) == from_sq64 && MoveUtils::get_to(move) == to_sq64) {
 				int promotion{ MoveUtils::get_prom(move) };
 				if (promotion != Enums::NO_PIECE) {
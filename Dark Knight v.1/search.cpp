@@ -4,6 +4,7 @@
 #include "print.h"
 #include "evaluation.h"
 #include "move_generator.h"
+#include "move_picker.h"
 #include "input_handle.h"
 
 #include <chrono>
@@ -22,7 +23,7 @@ namespace Search {
 	void reset_searchinfo(Boards::Board& position, SearchInformations& info) noexcept {
 		position.reset_search_heuristics();
 		position.reset_killer_moves();
-		position.reset_transp_table();
+		position.age_transp_table(); // The table is kept between searches, entries from older ones are replaced first
 		position.set_ply(0);
 		info.m_stopped = false;
 		info.m_nodes = 0;
@@ -33,7 +34,7 @@ namespace Search {
 		reset_searchinfo(position, info);
 		using namespace std::chrono;
 
-		int bestmove{ Enums::INCORRECT_MOVE };
+		COMPACT_MOVE bestmove{};
 		for (int cdepth{ 1 }; cdepth <= info.m_depth; ++cdepth) {
 			int max_score{ alpha_beta(position, info, -Enums::INF, Enums::INF, cdepth) };
 			if (info.m_stopped) {
@@ -71,10 +72,17 @@ namespace Search {
 			return Eval::evaluate_pos(position);
 		}
 
-		bool square_attacked{ position.is_square_attacked(position.king_location_index(position.turn()), position.turn() ^ 1) };
+		bool square_attacked{ position.in_check() };
 		if (square_attacked) ++depthleft;
 
+		// No cutoff at the root, where the best move has to come from a full search
+		int tt_move{ Enums::INCORRECT_MOVE };
+		int tt_eval{ TT::NO_EVAL };
 		int score{ -Enums::INF };
+		if (position.probe_transposition(tt_move, score, tt_eval, alpha, beta, depthleft) && position.ply()) {
+			return score;
+		}
+
 		if (null_move_possible && !square_attacked && position.ply() && depthleft >= 4 && (position.big_pieces_index(position.turn()) > 0)) {
 			position.make_nullmove();
 			score = -alpha_beta(position, info, -beta, -beta + 1, depthleft - 4, false);
@@ -83,26 +91,14 @@ namespace Search {
 			if (score >= beta) return beta;
 		}
 
-		MovesList ml;
-		ml.generate_moves(position);
+		MovePicker picker{ position, tt_move };
 		int temp_alpha{ alpha };
 		int tot_legals{};
 		int best_move{ Enums::INCORRECT_MOVE };
 
-		int transpmove{ position.get_transposition_move() };
-		if (transpmove != Enums::INCORRECT_MOVE) {
-			for (int cmove{}; cmove < ml.get_tot_moves(); ++cmove) {
-				if (ml[cmove].move == transpmove) {
-					ml.set_score(cmove, Enums::TRANSP_MOVE); // principal variation move
-					break;
-				}
-			}
-		}
-
 		int bestscore{ -Enums::INF };
-		for (int cmove{}; cmove < ml.get_tot_moves(); ++cmove) {
-			choose_bestmove(cmove, ml);
-			if (!position.make_move(ml[cmove].move)) continue;
+		for (int move{ picker.next_move() }; move != Enums::INCORRECT_MOVE; move = picker.next_move()) {
+			position.make_legal_move(move);
 			++tot_legals;
 			int curr_score{ -alpha_beta(position, info, -beta, -alpha, depthleft - 1) };
 			position.unmake_move();
@@ -111,23 +107,23 @@ namespace Search {
 			}
 			if (curr_score > bestscore) {
 				bestscore = curr_score;
-				best_move = ml[cmove].move;
+				best_move = move;
 
 				if (curr_score > alpha) {
 					if (curr_score >= beta) {
 						if (tot_legals == 1) ++info.m_fail_high_first;
 						++info.m_fail_high;
-						if (!(ml[cmove].move & MoveUtils::capture)) {
+						COMPACT_MOVE compact{ MoveUtils::compress(move) };
+						if (!(move & MoveUtils::capture) && compact != position.killer_moves_index(0, position.ply())) { // Both killers stay different
 							position.set_killers(1, position.ply(), position.killer_moves_index(0, position.ply()));
-							position.set_killers(0, position.ply(), ml[cmove].move);
-
+							position.set_killers(0, position.ply(), compact);
 						}
-						position.set_transposition_move(best_move);
+						position.store_transposition(best_move, beta, TT::NO_EVAL, depthleft, TT::BETA);
 						return beta;
 					}
 					alpha = curr_score;
-					best_move = ml[cmove].move;
-					if (!(ml[cmove].move & MoveUtils::capture)) {
+					best_move = move;
+					if (!(move & MoveUtils::capture)) {
 						position.incr_search_heuristic_val(position.pieces_index(MoveUtils::get_from(best_move)), MoveUtils::get_to(best_move), depthleft);
 					}
 				}
@@ -143,31 +139,18 @@ namespace Search {
 
 		// Alpha is now better
 		if (alpha != temp_alpha) {
-			position.set_transposition_move(best_move);
+			position.store_transposition(best_move, alpha, TT::NO_EVAL, depthleft, TT::EXACT);
 		}
 		else {
-			position.set_transposition_move(best_move);
+			position.store_transposition(best_move, alpha, TT::NO_EVAL, depthleft, TT::ALPHA);
 		}
 
 		return alpha;
 	}
 
-	// order moves in the best-move table
-	constexpr void choose_bestmove(int moven, MovesList& ml) noexcept {
-		int best_score{};
-		int moven_best{ moven };
-		for (int curr{ moven + 1 }; curr < ml.get_tot_moves(); ++curr) {
-			if (ml[curr].score > best_score) {
-				best_score = ml[curr].score;
-				moven_best = curr;
-			}
-		}
-		MovesList::Move tmp_move = ml[moven];
-		ml[moven] = ml[moven_best];
-		ml[moven_best] = tmp_move;
-	}
-
-	[[nodiscard]] int quiescence(Boards::Board& position, SearchInformations& info, int alpha, int beta) noexcept {
+	// quiet_checks: only true at the first quiescence ply, where quiet checking moves are searched after the captures.
+	// When in check there's no stand pat: every evasion is searched, so that a check can actually lead to a mate.
+	[[nodiscard]] int quiescence(Boards::Board& position, SearchInformations& info, int alpha, int beta, bool quiet_checks) noexcept {
 		if ((info.m_nodes % 2053) == 0) {
 			stop(info);
 		}
@@ -180,26 +163,39 @@ namespace Search {
 			return Eval::evaluate_pos(position);
 		}
 
-		int score{ Eval::evaluate_pos(position) };
-		if (score >= beta) {
-			return beta;
+		// Any stored result is deep enough here, and a stored network score saves running the network again
+		int tt_move{ Enums::INCORRECT_MOVE };
+		int eval{ TT::NO_EVAL };
+		int score{};
+		if (position.probe_transposition(tt_move, score, eval, alpha, beta, 0)) {
+			return score;
 		}
-		if (score > alpha) {
-			alpha = score;
+
+		FAST_64UI checkers{ position.checkers() };
+		if (!checkers) {
+			if (eval == TT::NO_EVAL) eval = Eval::network_score(position);
+			score = Eval::scale_rule50(eval, position);
+			if (score >= beta) {
+				position.store_transposition(Enums::INCORRECT_MOVE, beta, eval, 0, TT::BETA);
+				return beta;
+			}
+			if (score > alpha) {
+				alpha = score;
+			}
 		}
 
-		MovesList ml;
-		ml.gen_captures_only(position);
+		MovePicker picker{ position, quiet_checks, tt_move };
 		int temp_alpha{ alpha };
 		int tot_legals{};
 		int best_move{ Enums::INCORRECT_MOVE };
 		score = -Enums::INF;
 
-		for (int cmove{}; cmove < ml.get_tot_moves(); ++cmove) {
-			choose_bestmove(cmove, ml);
-			if (!position.make_move(ml[cmove].move)) continue;
+		for (int move{ picker.next_move() }; move != Enums::INCORRECT_MOVE; move = picker.next_move()) {
+			// Losing captures (and quiet checks that just give away the piece) are not worth searching, unless evading a check
+			if (!checkers && !position.see_ge(move, 0)) continue;
+			position.make_legal_move(move);
 			++tot_legals;
-			score = -quiescence(position, info, -beta, -alpha);
+			score = -quiescence(position, info, -beta, -alpha, false);
 			position.unmake_move();
 			if (info.m_stopped) {
 				return 0; // Stop right away and ignore everything in the current search
@@ -211,12 +207,16 @@ namespace Search {
 					return beta;
 				}
 				alpha = score;
-				best_move = ml[cmove].move;
+				best_move = move;
 			}
 		}
 
+		if (checkers && tot_legals == 0) {
+			return (-Enums::MATE) + position.ply();
+		}
+
 		if (alpha != temp_alpha) {
-			position.set_transposition_move(best_move);
+			position.store_transposition(best_move, alpha, eval, 0, TT::EXACT);
 		}
 
 		return alpha;
@@ -7,8 +7,6 @@ namespace Boards {
 	class Board;
 }
 
-class MovesList;
-
 namespace Search {
 	struct SearchInformations {
 		double m_fail_high{};
@@ -39,9 +37,7 @@ namespace Search {
 
 	void stop(SearchInformations& info) noexcept;
 
-	[[nodiscard]] int quiescence(Boards::Board& position, SearchInformations& info, int alpha, int beta) noexcept;
-
-	constexpr void choose_bestmove(int moven, MovesList& ml) noexcept;
+	[[nodiscard]] int quiescence(Boards::Board& position, SearchInformations& info, int alpha, int beta, bool quiet_checks = true) noexcept;
 }
 
 
@@ -2,18 +2,65 @@
 #include "board.h"
 #include "move_generator.h"
 #include "bitboard.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#ifdef _WIN32
+#  define NOMINMAX
+#  include <windows.h>
+#elif defined(__linux__)
+#  include <sys/mman.h>
+#endif
 
 namespace TT {
+	namespace {
+		constexpr std::size_t LARGE_PAGE_SIZE{ 2 * 1048576 };
+
+		// Returns zeroed memory aligned at least to a cache line, nullptr if even the fallback fails.
+		// size must be a multiple of LARGE_PAGE_SIZE
+		[[nodiscard]] void* allocate_table(std::size_t size) noexcept {
+#if defined(_WIN32)
+			// Large pages need the "Lock pages in memory" privilege, without it the first call fails
+			void* memory{ VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE) };
+			if (!memory) memory = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			return memory;
+#elif defined(__linux__)
+			// Explicit huge pages only exist if the administrator reserved them, otherwise ask for transparent ones
+			void* memory{ mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0) };
+			if (memory != MAP_FAILED) return memory;
+			memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (memory == MAP_FAILED) return nullptr;
+			madvise(memory, size, MADV_HUGEPAGE);
+			return memory;
+#else
+			void* memory{ std::aligned_alloc(alignof(Cluster), size) };
+			if (memory) std::memset(memory, 0, size);
+			return memory;
+#endif
+		}
+
+		void free_table(void* memory, [[maybe_unused]] std::size_t size) noexcept {
+			if (!memory) return;
+#if defined(_WIN32)
+			VirtualFree(memory, 0, MEM_RELEASE);
+#elif defined(__linux__)
+			munmap(memory, size);
+#else
+			std::free(memory);
+#endif
+		}
+	}
+
 	[[nodiscard]] int get_best_line(int depth, Boards::Board& pos) noexcept {
 		int index{};
-		MovesList movelist;
 		int currmove{ pos.get_transposition_move() };
 
-
 		while (currmove != Enums::INCORRECT_MOVE && index < depth) {
-			if (movelist.move_check(pos, currmove)) { // Move's legal
-				pos.make_move(currmove);
-				pos.set_pv_moves(index++, currmove);
+			// Sanity check in case two positions have the same zobrist key, without generating the moves
+			if (pos.is_pseudo_legal(currmove) && pos.is_legal(currmove)) {
+				pos.make_legal_move(currmove);
+				pos.set_pv_moves(index++, MoveUtils::compress(currmove));
 			}
 			else break;
 
@@ -26,25 +73,72 @@ namespace TT {
 		return index;
 	}
 
-	TranspositionTable::TranspositionTable(int size) noexcept {
-		tot_entries_cap = size * (1048576) / sizeof(InfoTT); // conversion to megabytes + how many entries can fit in that size
-		std::size_t tot_cap{ tot_entries_cap * sizeof(InfoTT) };
-		transposition_table.reserve(tot_cap);
-		transposition_table.resize(tot_cap);
+	TranspositionTable::~TranspositionTable() {
+		free_table(transposition_table, allocated_bytes);
 	}
 
+	// The memory comes back zeroed, so every entry starts empty. If the allocation fails the size is halved until it fits
 	void TranspositionTable::init(int new_size) noexcept {
-		tot_entries_cap = new_size * 1048576 / sizeof(InfoTT);
-		std::size_t tot_cap{ tot_entries_cap * sizeof(InfoTT) };
-		transposition_table.clear();
-		transposition_table.reserve(tot_cap);
-		transposition_table.resize(tot_cap);
+		free_table(transposition_table, allocated_bytes);
+		transposition_table = nullptr;
+
+		std::size_t megabytes{ static_cast<std::size_t>(std::clamp(new_size, 1, MAX_SIZE)) };
+		for (; megabytes && !transposition_table; megabytes /= 2) {
+			allocated_bytes = (megabytes * 1048576 + LARGE_PAGE_SIZE - 1) / LARGE_PAGE_SIZE * LARGE_PAGE_SIZE;
+			transposition_table = static_cast<Cluster*>(allocate_table(allocated_bytes));
+			if (!transposition_table) std::cout << "info string could not allocate " << megabytes << " MB for the hash table\n";
+			else tot_clusters = megabytes * 1048576 / sizeof(Cluster); // Only the requested size is used, the rest is page rounding
+		}
+		if (!transposition_table) std::abort();
+		generation = 0;
 	}
 
-	void TranspositionTable::set(int hashed_index, int best_move, FAST_64UI key, int depth) noexcept {
-		transposition_table[hashed_index].best_move = best_move;
-		transposition_table[hashed_index].key = key;
-		transposition_table[hashed_index].depth = depth;
+	[[nodiscard]] const InfoTT* TranspositionTable::probe(FAST_64UI key) const noexcept {
+		if (!tot_clusters) return nullptr;
+		std::uint16_t key16{ static_cast<std::uint16_t>(key) };
+		for (const auto& entry : get_cluster(key).entries) {
+			if (entry.key == key16 && entry.flags() != NONE) return &entry;
+		}
+		return nullptr;
+	}
+
+	// The entry of the same position is updated, otherwise the least valuable entry of the cluster is replaced:
+	// an empty one first, then the one with the lowest depth, each search of age costing 8 plies of depth
+	void TranspositionTable::store(FAST_64UI key, COMPACT_MOVE best_move, int score, int eval, int depth, int flags) noexcept {
+		auto worth = [this](const InfoTT& entry) {
+			int age{ ((GENERATION_CYCLE + generation - entry.gen_flags) & GENERATION_MASK) / GENERATION_DELTA };
+			return entry.depth - 8 * age;
+		};
+
+		if (!tot_clusters) return;
+		std::uint16_t key16{ static_cast<std::uint16_t>(key) };
+		Cluster& cluster{ get_cluster(key) };
+		InfoTT* replace{ &cluster.entries[0] };
+		for (auto& entry : cluster.entries) {
+			if (entry.flags() == NONE || entry.key == key16) {
+				replace = &entry;
+				break;
+			}
+			if (worth(entry) < worth(*replace)) replace = &entry;
+		}
+
+		// A shallower result for the same position only replaces the stored one if it is exact, and the stored move and evaluation
+		// are kept if there are no new ones
+		bool same_position{ replace->key == key16 && replace->flags() != NONE };
+		if (!best_move && same_position) best_move = replace->best_move;
+		if (eval == NO_EVAL && same_position) eval = replace->eval;
+		if (same_position && flags != EXACT && depth + 4 <= replace->depth) {
+			replace->best_move = best_move;
+			replace->gen_flags = static_cast<std::uint8_t>(generation | replace->flags());
+			return;
+		}
+
+		replace->key = key16;
+		replace->best_move = best_move;
+		replace->score = static_cast<std::int16_t>(score);
+		replace->eval = static_cast<std::int16_t>(eval);
+		replace->depth = static_cast<std::uint8_t>(depth);
+		replace->gen_flags = static_cast<std::uint8_t>(generation | flags);
 	}
 
 }
\ No newline at end of file
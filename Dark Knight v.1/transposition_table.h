@@ -2,8 +2,10 @@
 #define TRANSPOSITION_TABLE
 
 #include "utilities.h"
+#include <array>
 #include <cstdint>
-#include <vector>
+#include <cstring>
+#include <xmmintrin.h>
 
 
 namespace Boards {
@@ -13,51 +15,102 @@ namespace Boards {
 
 namespace TT {
 	// Stores all information related to the transposition table
+	// flags is the bound of score: ALPHA = upper bound (fail low), BETA = lower bound (fail high), EXACT = exact score
 	enum Flags { NONE, ALPHA, BETA, EXACT };
+
+	// Mate scores are stored as a distance to mate from the stored position, and made relative to the root again when read,
+	// since the same position can be reached at different plies
+	constexpr inline int IS_MATE{ Enums::MATE - Cnst::MAX_DEPTH };
+
+	[[nodiscard]] constexpr int score_to_tt(int score, int ply) noexcept {
+		if (score > IS_MATE) return score + ply;
+		if (score < -IS_MATE) return score - ply;
+		return score;
+	}
+
+	[[nodiscard]] constexpr int score_from_tt(int score, int ply) noexcept {
+		if (score > IS_MATE) return score - ply;
+		if (score < -IS_MATE) return score + ply;
+		return score;
+	}
+
+	constexpr inline int NO_EVAL{ 32001 }; // Stored when the static evaluation of the position is not known
+
+	// 10 bytes: six of them fill a cache line (see Cluster)
 	struct InfoTT {
-		FAST_64UI key{};
-		int depth{};
-		int best_move{};
-		int flags{};
-		int score{};
-
-		constexpr void reset() noexcept {
-			key = {};
-			depth = best_move = flags = score = {};
-		}
+		std::uint16_t key{};		  // Lower 16 bits of the position key, the upper ones choose the cluster
+		COMPACT_MOVE best_move{};
+		std::int16_t score{};
+		std::int16_t eval{};		  // Eval::network_score, before the fifty move rule scaling (the key does not include the rule 50 counter)
+		std::uint8_t depth{};
+		std::uint8_t gen_flags{};	  // Generation of the search that stored it (bits 2 to 7) and flags (bits 0 and 1). NONE = empty entry
+
+		[[nodiscard]] constexpr int flags() const noexcept { return gen_flags & 0x3; }
+	};
+
+	constexpr inline int CLUSTER_SIZE{ 6 };
+	struct alignas(64) Cluster {
+		std::array<InfoTT, CLUSTER_SIZE> entries{};
 	};
+	static_assert(sizeof(Cluster) == 64, "A cluster must fill exactly one cache line");
 
+	// The generation is bumped at every new search, entries from older searches are replaced first
+	constexpr inline int GENERATION_DELTA{ 0x4 };
+	constexpr inline int GENERATION_CYCLE{ 0xFF + GENERATION_DELTA };
+	constexpr inline int GENERATION_MASK{ 0xFC };
 
+
+	constexpr inline int DEFAULT_SIZE{ 16 };		// Megabytes
+	constexpr inline int MAX_SIZE{ 65536 };
+
+	// The table is a single allocation, backed by large pages where the system provides them (see allocate_table).
+	// It starts empty (nothing is stored and every probe misses) until init is called
 	class TranspositionTable {
 	private:
-		std::vector<InfoTT> transposition_table{};
-		int tot_entries_cap{};
+		Cluster* transposition_table{};
+		std::size_t tot_clusters{};
+		std::size_t allocated_bytes{};
+		std::uint8_t generation{};
+
+		// Multiply-shift: maps the key onto [0, tot_clusters) without a division
+		[[nodiscard]] __forceinline Cluster& get_cluster(FAST_64UI key) noexcept {
+			return transposition_table[Utils::mul_hi64(key, tot_clusters)];
+		}
+		[[nodiscard]] __forceinline const Cluster& get_cluster(FAST_64UI key) const noexcept {
+			return transposition_table[Utils::mul_hi64(key, tot_clusters)];
+		}
 
 	public:
-		TranspositionTable(int size = 16) noexcept;
+		TranspositionTable() noexcept = default;
+		~TranspositionTable();
+		TranspositionTable(const TranspositionTable&) = delete;
+		TranspositionTable& operator=(const TranspositionTable&) = delete;
 
-		void init(int new_size) noexcept;
+		void init(int new_size) noexcept; // Size in megabytes, the table is cleared
 
-		void set(int hashed_index, int best_move, FAST_64UI key, int depth) noexcept;
+		void new_search() noexcept { generation += GENERATION_DELTA; }
 
-		// Getters
-		[[nodiscard]] __forceinline int get_size() const noexcept {
-			return tot_entries_cap;
+		// Starts loading the cluster of key into the cache, so that a later probe or store does not wait on memory
+		__forceinline void prefetch(FAST_64UI key) const noexcept {
+			if (tot_clusters) _mm_prefetch(reinterpret_cast<const char*>(&get_cluster(key)), _MM_HINT_T0);
 		}
 
-		[[nodiscard]] __forceinline FAST_64UI get_key(int index) const noexcept {
-			return transposition_table[index].key;
-		}
+		// Returns the entry of the position, nullptr if it is not stored
+		[[nodiscard]] const InfoTT* probe(FAST_64UI key) const noexcept;
 
-		[[nodiscard]] __forceinline int get_bestmove(int index) const noexcept {
-			return transposition_table[index].best_move;
+		// score must already be adjusted with score_to_tt, depth is the remaining depth of the search that stored it
+		void store(FAST_64UI key, COMPACT_MOVE best_move, int score, int eval, int depth, int flags) noexcept;
+
+		// Getters
+		[[nodiscard]] __forceinline std::size_t get_size() const noexcept {
+			return tot_clusters;
 		}
 
 		void reset_internal() noexcept {
-			transposition_table = {};
+			if (transposition_table) std::memset(static_cast<void*>(transposition_table), 0, tot_clusters * sizeof(Cluster));
 		}
 
-		constexpr auto& get_transposition_table() const noexcept { return transposition_table; }
+		constexpr const Cluster* get_transposition_table() const noexcept { return transposition_table; }
 	}; // TranspositionTable
 
 	[[nodiscard]] int get_best_line(int depth, Boards::Board& pos) noexcept;
@@ -6,8 +6,13 @@
 
 #include <iostream>
 #include <chrono>
+#include <charconv>
+#include <algorithm>
+#include <cctype>
+#include <string_view>
 
 #define START_POS "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 0 "
+constexpr std::string_view HASH_OPTION{ "setoption name Hash value " };
 
 namespace UCI {
 	void go_parser(const std::string& str, Search::SearchInformations& info, Boards::Board& pos) noexcept {
@@ -122,7 +127,7 @@ namespace UCI {
 
 		Boards::Board position;
 		Search::SearchInformations si;
-		position.transp_table_init(10);
+		position.transp_table_init(TT::DEFAULT_SIZE);
 
 		while (!si.m_quit) {
 			if (!std::getline(std::cin, line) || line.empty()) {
@@ -138,6 +143,22 @@ namespace UCI {
 			else if (line == "ucinewgame") {
 				std::string s{ "position startpos\\n" };
 				position_parser(s, position);
+				position.reset_transp_table();
+			}
+			else if (line == "setoption name Clear Hash") {
+				position.reset_transp_table();
+			}
+			else if (line.starts_with(HASH_OPTION)) {
+				// Values that are not numbers are ignored, the others are clamped by the table
+				std::string_view value{ line };
+				value.remove_prefix(HASH_OPTION.size());
+				while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) value.remove_suffix(1);
+
+				long long megabytes{};
+				auto [end, error] { std::from_chars(value.data(), value.data() + value.size(), megabytes) };
+				if (error == std::errc{} && end == value.data() + value.size()) {
+					position.transp_table_init(static_cast<int>(std::clamp<long long>(megabytes, 0, TT::MAX_SIZE)));
+				}
 			}
 			else if (line.find("go") != std::string::npos) {
 				go_parser(line, si, position);
@@ -149,6 +170,8 @@ namespace UCI {
 			else if (line == "uci") {
 				std::cout << "id name Dark Knight\n";
 				std::cout << "id author SoWeBegin\n";
+				std::cout << "option name Hash type spin default " << TT::DEFAULT_SIZE << " min 1 max " << TT::MAX_SIZE << '\n';
+				std::cout << "option name Clear Hash type button\n";
 				std::cout << "uciok\n";
 			}
 
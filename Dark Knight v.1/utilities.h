@@ -11,6 +11,15 @@
 #endif
 #include <cassert>
 
+// Copy-make: every move copies the position state (Boards::PositionState) one slot up a stack and unmaking
+// only steps back and puts the moved pieces back on the mailbox, instead of restoring the state piece by piece.
+// No undo record is kept, the repetition check reads the keys of the stack. Define it here or in the project settings to enable it
+// #define COPY_MAKE
+
+// Attack maps: the squares attacked by the side not to move are stored with the check info of every ply. Castling, king moves
+// (Board::is_legal) and undefended exchanges (Board::see_ge) become lookups instead of scans of the attackers. Define it to enable them
+// #define ATTACK_MAPS
+
 
 ///////////////////////////////////////////////////////////////////////////
 // General utilities used in the whole program, such as enums and constants
@@ -18,6 +27,7 @@
 
 
 using FAST_64UI = unsigned long long;
+using COMPACT_MOVE = std::uint16_t; // 16-bit move (see MoveUtils::compress)
 
 namespace Utils {
 	// Pretty function to calculate the correct square in a 64 board, given file and rank
@@ -30,6 +40,20 @@ namespace Utils {
 		return __builtin_ctzll(bitboard);
 	}
 
+	// Number of bits set to 1 (Bitboard::bit_count, for the headers that cannot include bitboard.h)
+	[[nodiscard]] __forceinline static int popcount(FAST_64UI bitboard) noexcept {
+		return static_cast<int>(__popcnt64(bitboard));
+	}
+
+	// Upper 64 bits of the 128-bit product: maps a uniform 64-bit value onto [0, range)
+	[[nodiscard]] __forceinline static FAST_64UI mul_hi64(FAST_64UI value, FAST_64UI range) noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+		return __umulh(value, range);
+#else
+		return static_cast<FAST_64UI>((static_cast<unsigned __int128>(value) * range) >> 64);
+#endif
+	}
+
 	// To fix: BitScanReverse64 (Move MSVC -> Clang builtin)
 	[[nodiscard]] inline static int msb(FAST_64UI bitboard) noexcept {
 		unsigned long ret;
@@ -39,8 +63,8 @@ namespace Utils {
 }
 
 namespace Cnst {
-	// Theoretically, the max total moves in a chess game (Considering 50-moves-rule) is 5898.5. If we wanted though, we could reduce this to 2000, since we probably expect a chess game to never reach such a number.
-	constexpr inline int MAX_TOTAL_MOVES{ 5898 };
+	// Initial size of the undo stack of a Board: a whole game rarely needs more, and it grows on demand otherwise
+	constexpr inline int HISTORY_RESERVE{ 256 };
 	constexpr inline int MAX_POS_MOVES{ 256 };
 	constexpr inline int MAX_SQUARES{ 120 }; // Keeps track of extra squares out of the board, to check whether a piece is inside the board or not
 	constexpr inline int OUT_OF_RANGE64{ 120 };